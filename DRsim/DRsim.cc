@@ -1,6 +1,7 @@
 #include <iostream>
 #include "DRsimDetectorConstruction.hh"
 #include "DRsimActionInitialization.hh"
+#include "DRsimPhysicsProfile.hh"
 
 #ifdef G4MULTITHREADED
 #include "G4MTRunManager.hh"
@@ -13,6 +14,8 @@
 #include "FTFP_BERT.hh"
 #include "Randomize.hh"
 
+#include "TROOT.h"
+
 #ifdef G4VIS_USE
 #include "G4VisExecutive.hh"
 #endif
@@ -33,12 +36,17 @@ int main(int argc, char** argv) {
   if (argc > 2) seed = atoi(argv[2]);
   if (argc > 3) filename = argv[3];
 
+  // the output writer, the HepMC reader and per-thread files do ROOT I/O from several threads;
+  // enabled once before the run manager starts any of them
+  ROOT::EnableThreadSafety();
+
   CLHEP::HepRandom::setTheEngine(new CLHEP::RanecuEngine);
   CLHEP::HepRandom::setTheSeed(seed);
 
   // Construct the default run manager
   #ifdef G4MULTITHREADED
   G4MTRunManager* runManager = new G4MTRunManager;
+  runManager->SetSeedOncePerCommunication(0); // one seed per event, results do not depend on the thread count
   #else
   G4RunManager* runManager = new G4RunManager;
   #endif
@@ -54,6 +62,11 @@ int main(int argc, char** argv) {
   opticalPhysics->Configure(kScintillation, true);
   opticalPhysics->SetTrackSecondariesFirst(kCerenkov, true);
   opticalPhysics->SetTrackSecondariesFirst(kScintillation, true);
+
+  // full-optical unless the 4th argument or /DRsim/physics/profile says otherwise;
+  // /DRsim/geometry/fastOptical adds G4FastSimulationPhysics through it
+  DRsimPhysicsProfile* physicsProfile = new DRsimPhysicsProfile(physicsList,opticalPhysics);
+  if (argc > 4) physicsProfile->Apply(argv[4]);
   runManager->SetUserInitialization(physicsList);
 
   // User action initialization
@@ -93,6 +106,7 @@ int main(int argc, char** argv) {
   #ifdef G4VIS_USE
   delete visManager;
   #endif
+  delete physicsProfile;
   delete runManager;
 
   return 0;
@@ -16,6 +16,7 @@ public:
 
 private:
   void DefineCommands();
+  void BenchmarkSiPM(G4String filename);
 
   G4GenericMessenger* fMessenger;
   G4int fSeed;
@@ -23,6 +24,7 @@ private:
   G4bool fUseHepMC;
   G4bool fUseCalib;
   G4bool fUseGPS;
+  G4bool fUsePythia;
 };
 
 #endif
@@ -0,0 +1,35 @@
+#ifndef DRsimBinnedHist_h
+#define DRsimBinnedHist_h 1
+
+#include "DRsimInterface.h"
+
+#include "globals.hh"
+#include <vector>
+
+// Flat histogram with nBin regular bins of edge(i) = start + i*step plus
+// two sentinel bins: index 0 lies before edge(0), index nBin+1 beyond edge(nBin).
+// A negative step gives a descending axis (e.g. wavelength from 900 to 300 nm).
+class DRsimBinnedHist {
+public:
+  DRsimBinnedHist();
+  DRsimBinnedHist(G4int nBin, G4float start, G4float step);
+  ~DRsimBinnedHist() {};
+
+  void Fill(G4int bin, G4int weight = 1) { fCounts[bin] += weight; }
+  void Reset();
+
+  G4int GetNbins() const { return fNbin; }
+  G4float GetEdge(G4int i) const { return fStart + (float)i*fStep; }
+  G4int GetCount(G4int bin) const { return fCounts[bin]; }
+
+  DRsimInterface::hitRange GetRange(G4int bin) const;
+  std::map<DRsimInterface::hitRange, int> ToMap() const;
+
+private:
+  G4int fNbin;
+  G4float fStart;
+  G4float fStep;
+  std::vector<G4int> fCounts;
+};
+
+#endif
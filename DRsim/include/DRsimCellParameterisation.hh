@@ -1,6 +1,8 @@
 #ifndef DRsimCellParameterisation_h
 #define DRsimCellParameterisation_h 1
 
+#include "DRsimGeometryDescriptor.hh"
+
 #include "globals.hh"
 #include "G4VPVParameterisation.hh"
 #include "G4VisAttributes.hh"
@@ -9,7 +11,9 @@ class G4VPhysicalVolume;
 
 class DRsimCellParameterisation : public G4VPVParameterisation {
 public:
-  DRsimCellParameterisation(const G4int numx, const G4int numy);
+  DRsimCellParameterisation(const DRsimGeometryDescriptor& geom);
+
+  G4int GetNofCopies() const { return (G4int)fXCell.size(); }
   virtual ~DRsimCellParameterisation();
 
   virtual void ComputeTransformation(const G4int copyNo, G4VPhysicalVolume* physVol) const;
@@ -16,12 +16,15 @@
 #include "G4GenericMessenger.hh"
 #include "G4FieldManager.hh"
 #include "G4ThreeVector.hh"
+#include "G4Region.hh"
 
 #include "dimensionCalc.hh"
+#include "DRsimGeometryDescriptor.hh"
 
 using namespace std;
 
 class DRsimMagneticField;
+class DRsimGeometryCache;
 
 class DRsimDetectorConstruction : public G4VUserDetectorConstruction {
 public:
@@ -33,6 +36,7 @@ public:
 
   static int fNofModules;
   static int fNofRow;
+  static bool fHasReflector; // doReflector of the current geometry
 
 private:
   void DefineCommands();
@@ -40,13 +44,29 @@ private:
   G4Material* FindMaterial(G4String matName) { return fMaterials->GetMaterial(matName); }
   G4OpticalSurface* FindSurface(G4String surfName) { return fMaterials->GetOpticalSurface(surfName); }
 
-  void ModuleBuild(G4LogicalVolume* ModuleLogical_[], G4LogicalVolume* PMTGLogical_[], G4LogicalVolume* PMTfilterLogical_[], G4LogicalVolume* PMTcellLogical_[], G4LogicalVolume* PMTcathLogical_[],
-                    G4LogicalVolume* ReflectorMirrorLogical_[],
-                    std::vector<G4LogicalVolume*> fiberUnitIntersection_[], std::vector<G4LogicalVolume*> fiberCladIntersection_[], std::vector<G4LogicalVolume*> fiberCoreIntersection_[], 
+  void ModuleBuild(std::vector<G4LogicalVolume*>& ModuleLogical_, std::vector<G4LogicalVolume*>& PMTGLogical_, std::vector<G4LogicalVolume*>& PMTfilterLogical_, std::vector<G4LogicalVolume*>& PMTcellLogical_, std::vector<G4LogicalVolume*>& PMTcathLogical_,
+                    std::vector<G4LogicalVolume*>& ReflectorMirrorLogical_,
+                    std::vector<std::vector<G4LogicalVolume*>>& fiberUnitIntersection_, std::vector<std::vector<G4LogicalVolume*>>& fiberCladIntersection_, std::vector<std::vector<G4LogicalVolume*>>& fiberCoreIntersection_, 
                     std::vector<DRsimInterface::DRsimModuleProperty>& towerProps_);
 
-  void FiberImplement(G4int i, G4LogicalVolume* ModuleLogical__[], 
-                   std::vector<G4LogicalVolume*> fiberUnitIntersection__[], std::vector<G4LogicalVolume*> fiberCladIntersection__[], std::vector<G4LogicalVolume*> fiberCoreIntersection__[]);
+  void FiberImplement(G4int i, std::vector<G4LogicalVolume*>& ModuleLogical__, 
+                   std::vector<std::vector<G4LogicalVolume*>>& fiberUnitIntersection__, std::vector<std::vector<G4LogicalVolume*>>& fiberCladIntersection__, std::vector<std::vector<G4LogicalVolume*>>& fiberCoreIntersection__);
+  void LoadGeometry(G4String filename) { fGeom.Load(filename); }
+  void SetFastOptical(G4bool fastOptical);
+
+  // "Absorber" and "FiberCore" regions with the cuts of DRsimPhysicsProfile
+  void RegionsBuild();
+  void FiberCoreRegionBuild();
+  void SetRegionCut(G4Region* region, G4double cut);
+
+  G4String GeometryHash() const;
+  void RestoreFromCache(const DRsimGeometryCache& cache);
+  void SharedFiberBuild();
+  G4bool FiberInsideModule(G4float fX, G4float fY) const;
+
+  void ReportVoxelStats();
+  void RunNavigationBenchmark(G4int nRay);
+  void RunPropertyBenchmark(G4int nLookup);
 
   G4bool checkOverlaps;
   G4GenericMessenger* fMessenger;
@@ -60,6 +80,9 @@ private:
   G4VisAttributes* fVisAttrGray;
   G4VisAttributes* fVisAttrGreen;
 
+  DRsimGeometryDescriptor fGeom;
+  G4String fCacheDir;
+
   G4double fFrontL;
   G4double fTowerDepth;
   G4double fModuleH;
@@ -74,6 +97,16 @@ private:
   G4bool doFiber;
   G4bool doReflector;
   G4bool doPMT;
+  G4bool fSharedFiber; // place one clad/core pair per fiber type instead of per-fiber Boolean solids
+  G4bool fFastOptical; // DRsimFastOpticalModel on the fiber cores
+  G4int fPropertyPoints; // energy grid of the fast model's pre-sampled optical properties, 0 : G4 interpolation
+
+  // voxelization of the fiber-dense module volumes, a negative smartless keeps the Geant4 default
+  G4double fModuleSmartless;
+  G4bool fModuleOptimise;
+
+  G4int fBenchModule;
+  G4double fBenchPhysicsStep;
 
   dimensionCalc* dimCalc;
 
@@ -93,17 +126,23 @@ private:
   G4VSolid* tfiberCladIntersection;
   G4VSolid* tfiberCoreIntersection;
 
-  G4LogicalVolume* ModuleLogical[100];
+  // one entry per module, sized from fGeom in Construct()
+  std::vector<G4LogicalVolume*> ModuleLogical;
+
+  std::vector<G4LogicalVolume*> PMTGLogical;
+  std::vector<G4LogicalVolume*> PMTcathLogical;
+  std::vector<G4LogicalVolume*> PMTcellLogical;
+  std::vector<G4LogicalVolume*> PMTfilterLogical;
+  std::vector<G4LogicalVolume*> ReflectorMirrorLogical;
 
-  G4LogicalVolume* PMTGLogical[100];
-  G4LogicalVolume* PMTcathLogical[100];
-  G4LogicalVolume* PMTcellLogical[100];
-  G4LogicalVolume* PMTfilterLogical[100];
-  G4LogicalVolume* ReflectorMirrorLogical[100];
+  std::vector<std::vector<G4LogicalVolume*>> fiberUnitIntersection;
+  std::vector<std::vector<G4LogicalVolume*>> fiberCladIntersection;
+  std::vector<std::vector<G4LogicalVolume*>> fiberCoreIntersection;
 
-  vector<G4LogicalVolume*> fiberUnitIntersection[100];
-  vector<G4LogicalVolume*> fiberCladIntersection[100];
-  vector<G4LogicalVolume*> fiberCoreIntersection[100];
+  G4LogicalVolume* fiberCladCLogical;
+  G4LogicalVolume* fiberCoreCLogical;
+  G4LogicalVolume* fiberCladSLogical;
+  G4LogicalVolume* fiberCoreSLogical;
 
   DRsimInterface::hitXY fTowerXY;
   std::vector<DRsimInterface::DRsimModuleProperty> fModuleProp;
@@ -137,6 +176,7 @@ private:
   std::vector<G4bool> fFiberWhich;
 
   G4LogicalVolume* worldLogical;
+  G4VPhysicalVolume* worldPhysical;
 
   G4String setModuleName(int i) {
     return "Module" + std::to_string(i);
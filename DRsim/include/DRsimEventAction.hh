@@ -7,6 +7,19 @@
 #include "G4UserEventAction.hh"
 #include "G4HCofThisEvent.hh"
 #include "G4Event.hh"
+#include "G4Timer.hh"
+
+// optical photon bookkeeping of DRsimStackingAction and the step count of DRsimSteppingAction
+struct DRsimPhotonCounts {
+  G4long tracked;
+  G4long killedPrescale;
+  G4long killedBackward; // heading away from the readout end, no reflector
+  G4long steps;          // all particles, counted with sPhotonStats only
+  G4double time;         // event wall time, s
+
+  void Add(const DRsimPhotonCounts& other);
+  void Print(const G4String& title) const;
+};
 
 class DRsimEventAction : public G4UserEventAction {
 public:
@@ -17,20 +30,41 @@ public:
   virtual void BeginOfEventAction(const G4Event*);
   virtual void EndOfEventAction(const G4Event*);
 
-  void fillEdeps(DRsimInterface::DRsimEdepData edepData);
+  void fillEdeps(const DRsimInterface::DRsimEdepData& edepData);
   void fillLeaks(DRsimInterface::DRsimLeakageData leakData);
 
+  DRsimPhotonCounts& GetPhotonCounts() { return fPhotonCounts; }
+  void countStep() { fPhotonCounts.steps++; }
+
+  // /DRsim/action/photonStats : print the counts per event and summed over the run
+  static G4bool sPhotonStats;
+  static void PrintRunPhotonCounts();
+
 private:
   void clear();
+  void skipEvent(); // numbered event that is not written
   void fillHits(DRsimSiPMHit* hit);
   void fillPtcs(G4PrimaryVertex* vtx, G4PrimaryParticle* ptc);
-  void queue();
 
+  void updateHighWater();
+
+  // reused across events: cleared at the start of each event but keeps its capacity
   DRsimInterface::DRsimEventData* fEventData;
-  std::map<int, DRsimInterface::DRsimTowerData> fTowerMap;
-  std::map<int, DRsimInterface::DRsimEdepData> fEdepMap;
+  std::vector<int> fTowerIdx; // ModuleNum -> index in fEventData->towers, -1 if absent
+  std::vector<DRsimInterface::DRsimEdepData> fEdeps; // per module, ModuleNum = -1 until first deposit
 
   std::vector<G4int> fSiPMCollID;
+
+  // largest sizes seen so far, used to reserve the event containers up front
+  std::size_t fTowerHWM;
+  std::size_t fEdepHWM;
+  std::size_t fLeakHWM;
+  std::size_t fPtcHWM;
+  std::vector<std::size_t> fSiPMHWM; // per module
+
+  DRsimPhotonCounts fPhotonCounts;
+  G4Timer fTimer;
+  static DRsimPhotonCounts sRunPhotonCounts; // all threads
 };
 
 #endif
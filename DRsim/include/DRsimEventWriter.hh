@@ -0,0 +1,63 @@
+#ifndef DRsimEventWriter_h
+#define DRsimEventWriter_h 1
+
+#include "DRsimRootInterface.h"
+#include "DRsimInterface.h"
+
+#include "G4Threading.hh"
+#include "G4AutoLock.hh"
+#include "globals.hh"
+
+#include <map>
+#include <thread>
+#include <vector>
+
+// Writes DRsim events from a dedicated thread in event_number order.
+// Workers hand over finished events and return immediately; events that arrive
+// ahead of their turn wait in a reorder buffer of at most maxPending events.
+// An event simulated as several sub-events is merged once all its parts are in.
+class DRsimEventWriter {
+public:
+  DRsimEventWriter(DRsimRootInterface* rootIO, G4int firstIdx, G4int maxPending);
+  ~DRsimEventWriter();
+
+  // takes ownership of evt, part subEvt of nSubEvt of its event_number, and returns
+  // an already written event for reuse (or 0); blocks only while the reorder buffer is full.
+  // An event with a negative or already passed event_number is refused and handed straight back
+  DRsimInterface::DRsimEventData* push(DRsimInterface::DRsimEventData* evt, G4int subEvt = 0, G4int nSubEvt = 1);
+  // part subEvt of event_number will not come (aborted event); the writer moves past it
+  // and drops the whole event, so every numbered event must be either pushed or skipped
+  void skip(G4int event_number, G4int subEvt = 0, G4int nSubEvt = 1);
+  // writes everything still pending, across events that never arrived, and stops the thread
+  void finish();
+
+  G4int GetNextIdx() const { return fNextIdx; }
+
+private:
+  struct Pending {
+    std::vector<DRsimInterface::DRsimEventData*> parts; // 0 for a skipped part
+    G4int nArrived = 0;
+    G4bool complete() const { return nArrived==(G4int)parts.size(); }
+  };
+
+  // false if evt is refused; called with fMutex held, may wait on fWorkerCV
+  G4bool admit(G4AutoLock& lock, G4int idx, DRsimInterface::DRsimEventData* evt, G4int subEvt, G4int nSubEvt);
+  G4bool ready() const { return !fPending.empty() && fPending.begin()->first == fNextIdx && fPending.begin()->second.complete(); }
+  void run();
+  // adds the SiPM counts and histograms, Edeps, leaks and primaries of from to into
+  static void merge(DRsimInterface::DRsimEventData& into, const DRsimInterface::DRsimEventData& from);
+
+  DRsimRootInterface* fRootIO;
+  std::map<G4int, Pending> fPending;
+  std::vector<DRsimInterface::DRsimEventData*> fFree; // written events kept with their capacity
+  G4int fNextIdx;
+  G4int fMaxPending;
+  G4bool fFinish;
+
+  G4Mutex fMutex;
+  G4Condition fWriterCV;
+  G4Condition fWorkerCV;
+  std::thread fThread;
+};
+
+#endif
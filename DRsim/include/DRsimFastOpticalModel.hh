@@ -0,0 +1,54 @@
+#ifndef DRsimFastOpticalModel_h
+#define DRsimFastOpticalModel_h 1
+
+#include "DRsimSiPMSD.hh"
+#include "DRsimPropertyTable.hh"
+
+#include "G4VFastSimulationModel.hh"
+#include "G4MaterialPropertyVector.hh"
+#include "G4Region.hh"
+#include "globals.hh"
+
+#include <vector>
+
+// Parameterised light transport for optical photons in the fiber cores.
+// Photons are killed where they are created; those inside the core/clad
+// acceptance cone towards the SiPM survive attenuation with the core ABSLENGTH,
+// the S-fiber filter TRANSMITTANCE and the SiPM EFFICIENCY, and are counted
+// directly in DRsimSiPMSD at t + (axial distance)/(group velocity).
+// Skew rays and cladding modes are not modelled.
+class DRsimFastOpticalModel : public G4VFastSimulationModel {
+public:
+  // nPropertyPoints > 0 pre-samples the optical properties on that many energies, see DRsimPropertyTable
+  DRsimFastOpticalModel(G4String name, G4Region* envelope, G4int nofFiber, G4double fiberHalfZ, G4double SiPMz, G4bool doReflector, G4int nPropertyPoints);
+  virtual ~DRsimFastOpticalModel() {};
+
+  virtual G4bool IsApplicable(const G4ParticleDefinition& particle);
+  virtual G4bool ModelTrigger(const G4FastTrack&) { return true; }
+  virtual void DoIt(const G4FastTrack& fastTrack, G4FastStep& fastStep);
+
+private:
+  DRsimSiPMSD* GetSD(G4int moduleNum);
+
+  struct MaterialTables {
+    G4bool filled = false;
+    DRsimPropertyTable rindex;
+    DRsimPropertyTable absLength;
+  };
+  const MaterialTables& GetTables(const G4Material* material); // missing properties have no vector
+
+  std::vector<DRsimSiPMSD*> fSD; // per module, looked up on first use
+
+  G4int fNofFiber;
+  G4double fFiberHalfZ;        // fiber ends at +-fFiberHalfZ along the module axis
+  G4double fSiPMz;             // cathode center in the module frame
+  G4double fGroupVelocity;     // same as RecoFiber
+  G4double fMirrorReflectivity; // 0 without reflector
+
+  G4int fPropertyPoints;
+  DRsimPropertyTable fFilterTransmittance;
+  DRsimPropertyTable fSiPMEfficiency;
+  std::vector<MaterialTables> fMaterialTables; // by G4Material index
+};
+
+#endif
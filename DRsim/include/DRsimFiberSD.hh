@@ -0,0 +1,34 @@
+#ifndef DRsimFiberSD_h
+#define DRsimFiberSD_h 1
+
+#include "DRsimSiPMSD.hh"
+#include "DRsimPhotonLUT.hh"
+
+#include "G4VSensitiveDetector.hh"
+#include "G4Step.hh"
+#include "G4TouchableHistory.hh"
+
+#include <vector>
+
+// Energy deposits in the fiber cores for the photon LUT.
+// In calibration mode they fill DRsimPhotonLUTBuilder, in use mode they are turned
+// into photoelectrons sampled from DRsimPhotonLUT and counted in DRsimSiPMSD.
+class DRsimFiberSD : public G4VSensitiveDetector {
+public:
+  DRsimFiberSD(const G4String& name, G4int nofFiber, G4double fiberHalfZ, G4double SiPMz);
+  virtual ~DRsimFiberSD() {};
+
+  virtual G4bool ProcessHits(G4Step* aStep, G4TouchableHistory*);
+
+private:
+  DRsimSiPMSD* GetSD(G4int moduleNum);
+
+  std::vector<DRsimSiPMSD*> fSD; // per module, looked up on first use
+  const DRsimPhotonLUT* fLUT;
+
+  G4int fNofFiber;
+  G4double fFiberHalfZ; // readout end at +fFiberHalfZ in the fiber frame
+  G4double fSiPMz;      // cathode center in the module frame
+};
+
+#endif
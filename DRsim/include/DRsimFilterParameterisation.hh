@@ -1,6 +1,8 @@
 #ifndef DRsimFilterParameterisation_h
 #define DRsimFilterParameterisation_h 1
 
+#include "DRsimGeometryDescriptor.hh"
+
 #include "globals.hh"
 #include "G4VPVParameterisation.hh"
 #include "G4VisAttributes.hh"
@@ -10,7 +12,9 @@ class G4VPhysicalVolume;
 
 class DRsimFilterParameterisation : public G4VPVParameterisation {
 public:
-  DRsimFilterParameterisation(const G4int numx, const G4int numy);
+  DRsimFilterParameterisation(const DRsimGeometryDescriptor& geom);
+
+  G4int GetNofCopies() const { return (G4int)fXFilter.size(); }
   virtual ~DRsimFilterParameterisation();
 
   virtual void ComputeTransformation(const G4int copyNo, G4VPhysicalVolume* physVol) const;
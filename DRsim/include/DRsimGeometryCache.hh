@@ -0,0 +1,40 @@
+#ifndef DRsimGeometryCache_h
+#define DRsimGeometryCache_h 1
+
+#include "DRsimInterface.h"
+#include "DRsimMaterials.hh"
+
+#include "G4VPhysicalVolume.hh"
+#include "G4LogicalVolume.hh"
+#include "globals.hh"
+
+#include <vector>
+
+// Built geometry stored as <base>.gdml plus a <base>.bindings side-car holding
+// what GDML does not restore faithfully: the SiPM cathode volume and tower size
+// of every module and the skin/border surfaces bound to DRsimMaterials' surfaces.
+// Requires Geant4 with GDML (G4LIB_USE_GDML), otherwise the cache is never hit.
+class DRsimGeometryCache {
+public:
+  DRsimGeometryCache(const G4String& basename);
+  ~DRsimGeometryCache() {};
+
+  G4bool Exists() const;
+  // null on failure, with the volume stores and surface tables emptied again
+  G4VPhysicalVolume* Load(DRsimMaterials* materials);
+  void Save(G4VPhysicalVolume* world, const std::vector<DRsimInterface::DRsimModuleProperty>& moduleProp, const std::vector<G4LogicalVolume*>& cathode) const;
+
+  const std::vector<DRsimInterface::DRsimModuleProperty>& GetModuleProp() const { return fModuleProp; }
+  const std::vector<G4String>& GetCathodeNames() const { return fCathodeNames; }
+
+private:
+  G4bool ReadBindings(DRsimMaterials* materials);
+
+  G4String fGDMLName;
+  G4String fBindingName;
+
+  std::vector<DRsimInterface::DRsimModuleProperty> fModuleProp;
+  std::vector<G4String> fCathodeNames;
+};
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef DRsimGeometryDescriptor_h
+#define DRsimGeometryDescriptor_h 1
+
+#include "G4ThreeVector.hh"
+#include "G4SystemOfUnits.hh"
+#include "globals.hh"
+
+// Tower grid and fiber lattice of DRsim, the single source for
+// DRsimDetectorConstruction, dimensionCalc and the SiPM parameterisations.
+// Set through /DRsim/geometry/ or read from a text file of "key value" lines.
+struct DRsimGeometryDescriptor {
+  DRsimGeometryDescriptor();
+
+  G4int nofRow;        // modules per row and column
+  G4int nofPlate;      // fiber columns per module
+  G4int nofFiber;      // fibers per plate
+  G4double fiberPitch;
+  G4double moduleH;
+  G4double moduleW;
+  G4double towerDepth;
+  G4double frontL;     // from the center of the world box to the module front face
+
+  static constexpr G4double SiPMSize = 1.2*mm;  // SiPM cell, filter and mirror boxes
+  static constexpr G4double worldHalf = 10.*m;  // half length of the world box
+
+  G4int NofModules() const { return nofRow*nofRow; }
+
+  // fiber (SiPM) center in the module frame
+  G4double FiberX(G4int column) const { return -moduleH/2. + column*fiberPitch + fiberPitch/2.; }
+  G4double FiberY(G4int row) const { return -moduleW/2. + row*fiberPitch + fiberPitch/2.; }
+
+  G4bool Load(const G4String& filename);
+  // readoutT : thickness of the SiPM and reflector layers outside the modules
+  G4bool Validate(G4double fiberRadius, G4double readoutT) const;
+  void Print() const;
+};
+
+#endif
@@ -1,6 +1,8 @@
 #ifndef DRsimMirrorParameterisation_h
 #define DRsimMirrorParameterisation_h 1
 
+#include "DRsimGeometryDescriptor.hh"
+
 #include "globals.hh"
 #include "G4VPVParameterisation.hh"
 #include "G4VisAttributes.hh"
@@ -10,7 +12,9 @@ class G4VPhysicalVolume;
 
 class DRsimMirrorParameterisation : public G4VPVParameterisation {
 public:
-  DRsimMirrorParameterisation(const G4int numx, const G4int numy);
+  DRsimMirrorParameterisation(const DRsimGeometryDescriptor& geom);
+
+  G4int GetNofCopies() const { return (G4int)fXMirror.size(); }
   virtual ~DRsimMirrorParameterisation();
 
   virtual void ComputeTransformation(const G4int copyNo, G4VPhysicalVolume* physVol) const;
@@ -0,0 +1,28 @@
+#ifndef DRsimNavigationBenchmark_h
+#define DRsimNavigationBenchmark_h 1
+
+#include "G4VPhysicalVolume.hh"
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+// Traces straight rays through one module with a private G4Navigator and
+// reports the navigation time per step. Geantino rays only stop at volume
+// boundaries; charged rays additionally cut each step at an exponentially
+// distributed physics step length, which exercises the relocation path a
+// multiple-scattering charged pion takes through the fiber lattice.
+class DRsimNavigationBenchmark {
+public:
+  DRsimNavigationBenchmark(G4VPhysicalVolume* world, G4VPhysicalVolume* module);
+  ~DRsimNavigationBenchmark() {};
+
+  void SetPhysicsStep(G4double step) { fPhysicsStep = step; }
+
+  void Run(G4int nRay, G4bool charged);
+
+private:
+  G4VPhysicalVolume* fWorld;
+  G4VPhysicalVolume* fModule;
+  G4double fPhysicsStep;
+};
+
+#endif
@@ -0,0 +1,103 @@
+#ifndef DRsimPhotonLUT_h
+#define DRsimPhotonLUT_h 1
+
+#include "globals.hh"
+
+#include <vector>
+
+// Photoelectron lookup table replacing optical transport in the fibers.
+// For each fiber type (0 : S, 1 : C) and distance of the emission point from the
+// readout end it holds the mean photoelectron yield per MeV deposited in the core,
+// the CDF of the arrival delay and the CDF of the detected wavelength.
+// File layout : DRsimPhotonLUTHeader followed by nType*nDepth records of
+// { yield, timeCDF[nTime], wavCDF[nWav] } as 32-bit floats.
+struct DRsimPhotonLUTHeader {
+  char magic[8];
+  G4int version;  // DRsimPhotonLUT::kVersion of the writer
+  G4int nType;
+  G4int nDepth;
+  G4int nTime;
+  G4int nWav;
+  G4float fiberLength; // mm
+  G4float timeMax;     // ns
+  G4float wavStart;    // nm, bins run downward
+  G4float wavEnd;
+};
+
+class DRsimPhotonLUT {
+public:
+  // "off", "calibrate" (fill the table from full optical transport) or "use" (optical physics off)
+  static G4String sMode;
+  static G4String sFilename; // relative to the directory DRsim runs in, as Reco's calib.csv
+  static G4double sFiberLength;
+
+  // bumped whenever the header or record layout changes
+  static const G4int kVersion = 2;
+
+  static G4String Path(); // sFilename as an absolute path
+
+  static G4bool IsCalibrating() { return sMode=="calibrate"; }
+  static G4bool IsUsing() { return sMode=="use"; }
+
+  // memory-mapped once and shared read-only by all threads
+  static const DRsimPhotonLUT* GetShared();
+  static void ReleaseShared();
+
+  G4int DepthBin(G4double distance) const;
+  G4double Yield(G4int type, G4int depthBin) const { return record(type,depthBin)[0]; }
+  G4double SampleDelay(G4int type, G4int depthBin) const;
+  G4double SampleEnergy(G4int type, G4int depthBin) const;
+
+private:
+  DRsimPhotonLUT(const G4String& filename);
+  ~DRsimPhotonLUT();
+
+  const G4float* record(G4int type, G4int depthBin) const { return fData + (type*fHeader->nDepth + depthBin)*fRecordSize; }
+
+  static DRsimPhotonLUT* sShared;
+
+  void* fMap;
+  size_t fMapSize;
+  const DRsimPhotonLUTHeader* fHeader;
+  const G4float* fData;
+  G4int fRecordSize;
+};
+
+// Per-thread accumulator of the calibration run, merged into one table at end of run.
+class DRsimPhotonLUTBuilder {
+public:
+  DRsimPhotonLUTBuilder(G4double fiberLength);
+  ~DRsimPhotonLUTBuilder() {};
+
+  static DRsimPhotonLUTBuilder* GetThreadBuilder();
+  static void MergeThread();
+  static void WriteMerged(const G4String& filename);
+
+  void FillEdep(G4int type, G4double distance, G4double edep);
+  void FillPhoton(G4int type, G4double distance, G4double delay, G4double energy, G4int weight);
+  void Merge(const DRsimPhotonLUTBuilder& other);
+  G4bool Write(const G4String& filename) const;
+
+  static const G4int kNType = 2;
+  static const G4int kNDepth = 100;
+  static const G4int kNTime = 400;
+  static const G4int kNWav = 60;
+
+private:
+  G4int depthBin(G4double distance) const;
+
+  static G4ThreadLocal DRsimPhotonLUTBuilder* sThreadBuilder;
+  static DRsimPhotonLUTBuilder* sMerged;
+
+  G4double fFiberLength;
+  G4double fTimeMax;
+  G4double fWavStart;
+  G4double fWavEnd;
+
+  std::vector<G4double> fEdep;    // [type][depth], MeV
+  std::vector<G4double> fNpe;     // [type][depth]
+  std::vector<G4double> fTime;    // [type][depth][time]
+  std::vector<G4double> fWav;     // [type][depth][wav]
+};
+
+#endif
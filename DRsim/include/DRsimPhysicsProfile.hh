@@ -0,0 +1,48 @@
+#ifndef DRsimPhysicsProfile_h
+#define DRsimPhysicsProfile_h 1
+
+#include "G4VModularPhysicsList.hh"
+#include "G4OpticalPhysics.hh"
+#include "G4FastSimulationPhysics.hh"
+#include "G4GenericMessenger.hh"
+#include "globals.hh"
+
+// Named physics configurations on top of FTFP_BERT + G4OpticalPhysics,
+// selected once before /run/initialize (4th command line argument or /DRsim/physics/profile) :
+//   full-optical : everything
+//   no-optical   : without optical photons, energy deposits only (calib, JER)
+//   EM-only-calo : no-optical without hadronic and photo-nuclear physics (e/gamma studies only)
+// Each profile also sets the production cuts of the "Absorber" (copper modules)
+// and "FiberCore" regions built in DRsimDetectorConstruction, see Apply();
+// /DRsim/physics/absorberCut and fiberCoreCut override them afterwards.
+// A negative cut keeps the default.
+// G4FastSimulationPhysics for optical photons is only registered on request, by
+// /DRsim/geometry/fastOptical True, so the other jobs carry no fast simulation process.
+class DRsimPhysicsProfile {
+public:
+  DRsimPhysicsProfile(G4VModularPhysicsList* physicsList, G4OpticalPhysics* opticalPhysics);
+  ~DRsimPhysicsProfile();
+
+  void Apply(G4String profile);
+
+  static void RequestFastSimulation();
+
+  static G4bool HasOptical() { return sProfile=="full-optical"; }
+
+  static G4String sProfile;
+  static G4double sAbsorberCut;
+  static G4double sFiberCoreCut;
+
+private:
+  void DefineCommands();
+
+  static DRsimPhysicsProfile* sInstance;
+
+  G4GenericMessenger* fMessenger;
+  G4VModularPhysicsList* fPhysicsList;
+  G4OpticalPhysics* fOpticalPhysics;
+  G4FastSimulationPhysics* fFastSimulationPhysics; // owned by the physics list once registered
+  G4bool fApplied;
+};
+
+#endif
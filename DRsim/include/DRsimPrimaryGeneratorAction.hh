@@ -13,10 +13,11 @@
 class G4GenericMessenger;
 class G4Event;
 class G4ParticleDefinition;
+class Pythia8G4Generator;
 
 class DRsimPrimaryGeneratorAction : public G4VUserPrimaryGeneratorAction {
 public:
-  DRsimPrimaryGeneratorAction(G4int seed, G4bool useHepMC, G4bool useCalib, G4bool useGPS);
+  DRsimPrimaryGeneratorAction(G4int seed, G4bool useHepMC, G4bool useCalib, G4bool useGPS, G4bool usePythia);
   virtual ~DRsimPrimaryGeneratorAction();
 
   virtual void GeneratePrimaries(G4Event*);
@@ -34,8 +35,16 @@ public:
   void SetRandX(G4double randx) { fRandX = randx; }
   void SetRandY(G4double randy) { fRandY = randy; }
 
+  // event_number of the current event : events of the previous runs plus the G4 event ID,
+  // so it only depends on the per-event seed and not on which thread ran the event;
+  // with HepMC input the position of the event in the file
   static G4ThreadLocal int sIdxEvt;
-  static int sNumEvt;
+  // part sSubEvt of sNumSubEvt of event sIdxEvt, see /DRsim/hepMC/subEvents
+  static G4ThreadLocal int sSubEvt;
+  static G4ThreadLocal int sNumSubEvt;
+  static int sNumEvt;  // beamOn events of the previous runs, advanced by the master at end of run
+
+  static void EndOfRun(G4int nofEvents);
 
 private:
   void DefineCommands();
@@ -46,6 +55,8 @@ private:
   G4bool fUseHepMC;
   G4bool fUseCalib;
   G4bool fUseGPS;
+  G4bool fUsePythia;
+  Pythia8G4Generator* fPythia; // created at the first event, after the macro set it up
   G4ParticleGun* fParticleGun;
   G4GeneralParticleSource* fGPS;
   G4GenericMessenger* fMessenger;
@@ -0,0 +1,44 @@
+#ifndef DRsimPropertyTable_h
+#define DRsimPropertyTable_h 1
+
+#include "G4MaterialPropertyVector.hh"
+#include "globals.hh"
+
+#include <vector>
+
+// Material property vector pre-sampled on a uniform energy grid, so that a
+// lookup is one multiply and one linear interpolation instead of a bin search.
+// Each owner keeps its own copy, which also avoids the shared bin cache of
+// G4PhysicsVector::Value between threads.
+// With nPoint = 0 Value() falls through to the G4MaterialPropertyVector.
+class DRsimPropertyTable {
+public:
+  DRsimPropertyTable();
+  DRsimPropertyTable(G4MaterialPropertyVector* vec, G4int nPoint);
+  ~DRsimPropertyTable() {};
+
+  G4double Value(G4double energy) const {
+    if ( fValues.empty() ) return fVector->Value(energy);
+
+    G4double x = (energy - fEmin)*fInvStep;
+    if ( !(x > 0.) ) return fValues.front();
+    if ( x >= fLast ) return fValues.back();
+
+    G4int i = (G4int)x;
+    return fValues[i] + (x-i)*(fValues[i+1]-fValues[i]);
+  }
+
+  G4MaterialPropertyVector* GetVector() const { return fVector; }
+
+  // time per lookup of G4MaterialPropertyVector::Value and of the dense table, and their largest difference
+  static void Benchmark(G4MaterialPropertyVector* vec, const G4String& name, G4int nPoint, G4int nLookup);
+
+private:
+  G4MaterialPropertyVector* fVector;
+  std::vector<G4double> fValues;
+  G4double fEmin;
+  G4double fInvStep;
+  G4double fLast; // index of the last grid point
+};
+
+#endif
@@ -1,9 +1,10 @@
 #ifndef DRsimRunAction_h
 #define DRsimRunAction_h 1
 
-#include "RootInterface.h"
+#include "DRsimRootInterface.h"
 #include "DRsimInterface.h"
 #include "HepMCG4Reader.hh"
+#include "DRsimEventWriter.hh"
 
 #include "G4UserRunAction.hh"
 #include "globals.hh"
@@ -19,10 +20,17 @@ public:
   virtual void EndOfRunAction(const G4Run*);
 
   static HepMCG4Reader* sHepMCreader;
-  static RootInterface<DRsimInterface::DRsimEventData>* sRootIO;
+  static DRsimRootInterface* sRootIO;
+  static DRsimEventWriter* sWriter;
+  static G4ThreadLocal DRsimRootInterface* sThreadRootIO; // per-thread output mode only
   static int sNumEvt;
+  static G4bool sUseV2;
+  static G4int sWriterBuffer;
+  static G4bool sPerThreadOutput;
 
 private:
+  DRsimRootInterface* openOutput(G4String filename);
+
   G4int fSeed;
   G4String fFilename;
   G4bool fUseHepMC;
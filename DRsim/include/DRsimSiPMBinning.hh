@@ -0,0 +1,34 @@
+#ifndef DRsimSiPMBinning_h
+#define DRsimSiPMBinning_h 1
+
+#include "globals.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4PhysicalConstants.hh"
+
+#include <vector>
+
+// Bin lookup of the SiPM time and wavelength axes from precomputed edges.
+// Both return the first edge index above the argument, i.e. 0 for underflow and nBin+1
+// for overflow, the bin numbering of DRsimBinnedHist. Edges are the float-rounded
+// values in nm/ns that DRsimBinnedHist reports, converted to G4 units.
+class DRsimSiPMBinning {
+public:
+  DRsimSiPMBinning();
+  DRsimSiPMBinning(G4int wavBin, G4float wavlenStart, G4float wavlenStep, G4int timeBin, G4float timeStart, G4float timeStep);
+  ~DRsimSiPMBinning() {};
+
+  G4int findWavBin(G4double en) const;
+  G4int findTimeBin(G4double stepTime) const;
+
+  static G4double wavToE(G4double wav) { return h_Planck*c_light/wav; }
+
+private:
+  G4int fTimeBin;
+  G4float fTimeStart;
+  G4float fTimeStep;
+
+  std::vector<G4double> fWavEdgeE;  // photon energy at each wavelength bin edge, ascending
+  std::vector<G4double> fTimeEdges; // time bin edges in G4 units, ascending
+};
+
+#endif
@@ -2,6 +2,7 @@
 #define DRsimSiPMHit_h 1
 
 #include "DRsimInterface.h"
+#include "DRsimBinnedHist.hh"
 
 #include "G4VHit.hh"
 #include "G4THitsCollection.hh"
@@ -11,7 +12,7 @@
 class DRsimSiPMHit : public G4VHit {
 public:
 
-  DRsimSiPMHit(G4int wavBin, G4int timeBin);
+  DRsimSiPMHit(const DRsimBinnedHist& wavHist, const DRsimBinnedHist& timeHist);
   DRsimSiPMHit(const DRsimSiPMHit &right);
   virtual ~DRsimSiPMHit();
 
@@ -24,7 +25,7 @@ public:
   void Draw();
   void Print();
 
-  void photonCount() { fPhotons++; }
+  void photonCount(G4int weight = 1) { fPhotons += weight; }
   G4int GetPhotonCount() const { return fPhotons; }
 
   void SetSiPMnum(G4int n) { fSiPMnum = n; }
@@ -48,11 +49,12 @@ public:
   void SetSiPMXY(DRsimInterface::hitXY xy) { fSiPMXY = xy; }
   DRsimInterface::hitXY GetSiPMXY() const { return fSiPMXY; }
 
-  void CountWavlenSpectrum(DRsimInterface::hitRange range);
-  DRsimInterface::DRsimWavlenSpectrum GetWavlenSpectrum() const { return fWavlenSpectrum; }
+  // bins follow the DRsimBinnedHist convention (0 and nBin+1 are the sentinels)
+  void CountWavlenSpectrum(G4int bin, G4int weight = 1) { fWavlenHist.Fill(bin,weight); }
+  DRsimInterface::DRsimWavlenSpectrum GetWavlenSpectrum() const { return fWavlenHist.ToMap(); }
 
-  void CountTimeStruct(DRsimInterface::hitRange range);
-  DRsimInterface::DRsimTimeStruct GetTimeStruct() const { return fTimeStruct; }
+  void CountTimeStruct(G4int bin, G4int weight = 1) { fTimeHist.Fill(bin,weight); }
+  DRsimInterface::DRsimTimeStruct GetTimeStruct() const { return fTimeHist.ToMap(); }
 
 private:
   G4int fSiPMnum;
@@ -63,11 +65,8 @@ private:
   G4float fInnerR;
   G4float fTowerH;
   DRsimInterface::hitXY fSiPMXY;
-  DRsimInterface::DRsimWavlenSpectrum fWavlenSpectrum;
-  DRsimInterface::DRsimTimeStruct fTimeStruct;
-
-  G4int fWavBin;
-  G4int fTimeBin;
+  DRsimBinnedHist fWavlenHist;
+  DRsimBinnedHist fTimeHist;
 };
 
 typedef G4THitsCollection<DRsimSiPMHit> DRsimSiPMHitsCollection;
@@ -2,6 +2,7 @@
 #define DRsimSiPMSD_h 1
 
 #include "DRsimSiPMHit.hh"
+#include "DRsimSiPMBinning.hh"
 #include "DRsimInterface.h"
 
 #include "G4VSensitiveDetector.hh"
@@ -10,6 +11,17 @@
 #include "G4Step.hh"
 #include "G4TouchableHistory.hh"
 
+#include <vector>
+#include <fstream>
+
+// one detected photon as written by /DRsim/action/recordSiPM, SiPMnum -1 marks a new event of the module
+struct DRsimSiPMRecord {
+  G4int module;
+  G4int SiPMnum;
+  G4double time;
+  G4double energy;
+};
+
 class DRsimSiPMSD : public G4VSensitiveDetector {
 public:
   DRsimSiPMSD(const G4String& name, const G4String& hitsCollectionName, DRsimInterface::DRsimModuleProperty ModuleProp);
@@ -19,8 +31,18 @@ public:
   virtual G4bool ProcessHits(G4Step* aStep, G4TouchableHistory*);
   virtual void EndOfEvent(G4HCofThisEvent* HCE);
 
+  // detected photon handed over by DRsimFastOpticalModel or DRsimFiberSD instead of a cathode step,
+  // weight is the photon pre-scale for photons that were tracked
+  void AddFastHit(G4int SiPMnum, G4double energy, G4double hitTime, const G4ThreeVector& SiPMpos, G4int weight);
+
+  // replays a recorded photon stream through the hit lookup, linear scan vs dense index
+  static void Benchmark(const G4String& filename);
+
+  static G4String sRecordPath; // writes <path>_t<thread>.bin if not empty
+
 private:
   DRsimSiPMHitsCollection* fHitCollection;
+  std::vector<DRsimSiPMHit*> fHitIndex; // dense SiPMnum -> hit lookup, rebuilt per event
   G4int fHCID;
   G4int fWavBin;
   G4int fTimeBin;
@@ -31,14 +53,22 @@ private:
   G4float fWavlenStep;
   G4float fTimeStep;
 
+  DRsimBinnedHist fWavlenHist;
+  DRsimBinnedHist fTimeHist;
+  DRsimSiPMBinning fBinning;
+
   G4int fModuleNum;
   DRsimInterface::hitXY fTowerXY;
 
-  G4double wavToE(G4double wav) { return h_Planck*c_light/wav; }
+  void resetHits();
+  DRsimSiPMHit* createHit(G4int SiPMnum, const G4ThreeVector& SiPMpos);
+  void countPhoton(DRsimSiPMHit* hit, G4double energy, G4double hitTime, G4int weight);
+  void fillLUT(const G4Step* step, G4int SiPMnum);
 
-  DRsimInterface::hitRange findWavRange(G4double en);
-  DRsimInterface::hitRange findTimeRange(G4double stepTime);
   DRsimInterface::hitXY findSiPMXY(G4int SiPMnum, DRsimInterface::hitXY towerXY);
+
+  static void record(const DRsimSiPMRecord& rec);
+  static G4ThreadLocal std::ofstream* sRecord;
 };
 
 #endif
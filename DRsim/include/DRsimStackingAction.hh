@@ -0,0 +1,30 @@
+#ifndef DRsimStackingAction_h
+#define DRsimStackingAction_h 1
+
+#include "DRsimEventAction.hh"
+
+#include "G4UserStackingAction.hh"
+#include "globals.hh"
+
+// Classifies new optical photons before they are tracked.
+// Keeps one in sPhotonPrescale of them; DRsimSiPMSD weights the detected ones
+// by sPhotonPrescale so that the expected counts are restored.
+// With sEarlyKill and no reflector, photons heading away from the readout end
+// (+z, the modules are unrotated) are killed as well, they cannot reach the SiPM plane.
+// Cerenkov photons need RINDEX and the only scintillator (polystyrene) has it, so
+// no photon is born in a volume it could not leave and that needs no check.
+class DRsimStackingAction : public G4UserStackingAction {
+public:
+  DRsimStackingAction(DRsimEventAction* eventAction);
+  virtual ~DRsimStackingAction() {};
+
+  virtual G4ClassificationOfNewTrack ClassifyNewTrack(const G4Track* track);
+
+  static G4int sPhotonPrescale;
+  static G4bool sEarlyKill;
+
+private:
+  DRsimEventAction* fEventAction;
+};
+
+#endif
@@ -3,10 +3,12 @@
 
 #include "DRsimInterface.h"
 #include "DRsimEventAction.hh"
+#include "DRsimDetectorConstruction.hh"
 
 #include "G4UserSteppingAction.hh"
 #include "G4LogicalVolume.hh"
 #include "G4Step.hh"
+#include "G4Material.hh"
 
 using namespace std;
 
@@ -20,16 +22,18 @@ private:
   DRsimEventAction* fEventAction;
   DRsimInterface::DRsimEdepData fEdep;
   DRsimInterface::DRsimLeakageData fLeak;
-  
+
+  // materials without energy deposit bookkeeping, resolved once
+  const G4Material* fVacuum;
+  const G4Material* fAir;
+
   G4VPhysicalVolume* GetMotherTower(G4TouchableHandle touchable) { return touchable->GetVolume(touchable->GetHistoryDepth()-1); }
 
-  G4int GetModuleNum(G4String towerName) {
-    
-    if (towerName.find("1") != std::string::npos) return 1;
-    if (towerName.find("2") != std::string::npos) return 2;
-    if (towerName.find("3") != std::string::npos) return 3;
-    if (towerName.find("4") != std::string::npos) return 4;
+  // modules and their PMTG boxes are placed with the module number as copy number
+  G4int GetModuleNum(G4TouchableHandle touchable) {
+    G4int moduleNum = GetMotherTower(touchable)->GetCopyNo();
 
+    return ( moduleNum >= 0 && moduleNum < DRsimDetectorConstruction::fNofModules ) ? moduleNum : -1;
   }
 };
 
@@ -6,6 +6,35 @@
 #include "HepMC3/GenVertex.h"
 #include "HepMC3/GenParticle.h"
 
+#include "G4VSolid.hh"
+
+#include <unordered_map>
+#include <vector>
+
+// plain copy of the final-state content of a HepMC event, in G4 units,
+// so that it can be decoded on one thread and turned into G4 primaries on another
+struct HepMCG4Particle {
+  G4int pdgId;
+  G4double px, py, pz;
+};
+
+struct HepMCG4Vertex {
+  G4double x, y, z, t;
+  std::vector<HepMCG4Particle> particles;
+};
+
+// index of the G4 vertex at a given position and time, to merge co-located vertices
+struct HepMCG4VertexKey {
+  G4double x, y, z, t;
+  bool operator==(const HepMCG4VertexKey& other) const { return x==other.x && y==other.y && z==other.z && t==other.t; }
+};
+
+struct HepMCG4VertexKeyHash {
+  size_t operator()(const HepMCG4VertexKey& key) const;
+};
+
+typedef std::unordered_map<HepMCG4VertexKey,G4int,HepMCG4VertexKeyHash> HepMCG4VertexLookup;
+
 /// A base class for primary generation via HepMC object.
 /// This class is derived from G4VPrimaryGenerator.
 
@@ -30,6 +59,16 @@ protected:
   virtual HepMC3::GenEvent* GenerateHepMCEvent();
 
 public:
+  // the two halves of HepMC2G4 : the status 1 particles of every vertex with a final-state
+  // particle (in vertex order, as the original HepMC2G4; the root vertex is not one of them),
+  // co-located vertices merged, then G4 primaries. Both drop vertices outside world unless it is null
+  static void HepMC2Vertices(const HepMC3::GenEvent* hepmcevt, const G4VSolid* world, std::vector<HepMCG4Vertex>& vertices);
+  static void Vertices2G4(const std::vector<HepMCG4Vertex>& vertices, G4Event* g4event, const G4VSolid* world = 0);
+
+  enum { kOutsideWorld = -1 };
+  // index of the vertex at pos in vertices, appended (and added to lookup) if new, or kOutsideWorld
+  static G4int FindVertex(const HepMC3::FourVector& pos, const G4VSolid* world, std::vector<HepMCG4Vertex>& vertices, HepMCG4VertexLookup& lookup);
+
   HepMCG4Interface();
   virtual ~HepMCG4Interface();
 
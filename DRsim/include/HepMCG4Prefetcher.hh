@@ -0,0 +1,49 @@
+#ifndef HEPMC_G4_PREFETCHER_h
+#define HEPMC_G4_PREFETCHER_h 1
+
+#include "HepMCG4Interface.hh"
+#include "HepMC3/ReaderRootTree.h"
+
+#include "G4Threading.hh"
+#include "G4AutoLock.hh"
+#include "globals.hh"
+
+#include <deque>
+#include <thread>
+#include <vector>
+
+// index in the file and decoded content of one HepMC event
+struct HepMCG4Record {
+  G4int idx;
+  std::vector<HepMCG4Vertex> vertices;
+};
+
+// Reads and decodes HepMC events on a dedicated thread into a queue of at most
+// queueSize records; consumers only pop. Events come out in file order, but with
+// several consumers they may be simulated out of order, hence the index.
+class HepMCG4Prefetcher {
+public:
+  HepMCG4Prefetcher(const G4String& path, G4int queueSize, G4int verbose);
+  ~HepMCG4Prefetcher();
+
+  // false once the file is exhausted
+  G4bool pop(HepMCG4Record& record);
+
+private:
+  void run();
+
+  HepMC3::ReaderRootTree* fReader;
+  std::deque<HepMCG4Record> fQueue;
+  G4int fQueueSize;
+  G4int fVerbose;
+  G4int fNextIdx;
+  G4bool fEnd;
+  G4bool fStop;
+
+  G4Mutex fMutex;
+  G4Condition fReaderCV;
+  G4Condition fConsumerCV;
+  std::thread fThread;
+};
+
+#endif
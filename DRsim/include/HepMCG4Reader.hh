@@ -2,20 +2,24 @@
 #define HEPMC_G4_READER_h 1
 
 #include "HepMCG4Interface.hh"
+#include "HepMCG4Prefetcher.hh"
 #include "HepMC3/ReaderRootTree.h"
 #include "HepMC3/Units.h"
 #include "HepMC3/Print.h"
 
+#include "G4Threading.hh"
+#include "G4AutoLock.hh"
+
+#include <memory>
+
 class G4GenericMessenger;
 
+// Shared by all workers : events are decoded ahead by a HepMCG4Prefetcher,
+// started on first use, and workers only pop them.
 class HepMCG4Reader : public HepMCG4Interface {
 protected:
-  HepMC3::ReaderRootTree* reader;
-
   G4int verbose;
 
-  virtual HepMC3::GenEvent* GenerateHepMCEvent();
-
 public:
   HepMCG4Reader(G4int seed, G4String hepMCpath);
   ~HepMCG4Reader();
@@ -25,12 +29,45 @@ public:
 
   void Initialize();
 
+  // fills the event and returns the index of the HepMC event in the file, -1 at end of file;
+  // with sub-events the G4 event only gets part subEvt of nSubEvt of its primaries
+  G4int GenerateEvent(G4Event* anEvent, G4int& subEvt, G4int& nSubEvt);
+  virtual void GeneratePrimaryVertex(G4Event* anEvent) { G4int subEvt, nSubEvt; GenerateEvent(anEvent,subEvt,nSubEvt); }
+
+  G4int GetSubEvents() const { return fSubEvents; }
+  // drops an event of which not all sub-events were handed out (aborted run)
+  void EndOfRun();
+
+  // events/s of the locked single reader and of the prefetcher for 1, 2, 4, ... consumer threads
+  void Benchmark(G4int nEvent);
+  // us/event of HepMC2Vertices against one G4 vertex per HepMC vertex
+  void BenchmarkConversion(G4int nEvent);
+
 private:
   void DefineCommands();
+  // primaries dealt heaviest first onto the part with the least momentum so far
+  static void SplitVertices(const std::vector<HepMCG4Vertex>& vertices, G4int nPart, std::vector<std::vector<HepMCG4Vertex>>& parts);
 
   G4GenericMessenger* fMessenger;
   G4int fSeed;
   G4String fHepMCpath;
+  G4int fQueueSize;
+
+  HepMCG4Prefetcher* fPrefetcher;
+  G4Mutex fMutex; // guards the creation of fPrefetcher and fOpen, held only to claim a part
+
+  // a HepMC event split into fSubEvents parts, one per G4 event. The G4 event that claims part 0
+  // pops and splits it outside the lock; the others wait for ready, parts is not modified after.
+  struct SplitEvent {
+    G4int idx; // -1 : end of file
+    size_t nextPart;
+    G4bool ready;
+    std::vector<std::vector<HepMCG4Vertex>> parts;
+  };
+
+  G4int fSubEvents; // G4 events each HepMC event is split into
+  std::shared_ptr<SplitEvent> fOpen; // split event with unclaimed parts
+  G4Condition fReadyCV;
 };
 
 #endif
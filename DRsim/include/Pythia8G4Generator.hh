@@ -0,0 +1,56 @@
+#ifndef PYTHIA8_G4_GENERATOR_h
+#define PYTHIA8_G4_GENERATOR_h 1
+
+#include "HepMCG4Interface.hh"
+
+#include "G4VPrimaryGenerator.hh"
+#include "G4Event.hh"
+#include "globals.hh"
+
+#include <vector>
+
+namespace Pythia8 { class Pythia; }
+namespace HepMC3 { class Pythia8ToHepMC3; class WriterRootTree; }
+class P8filter;
+class P8ptcgun;
+
+// Runs Pythia8 inside DRsim, one instance per worker thread, and turns the
+// final-state particles straight into G4 primaries. Each event reseeds Pythia from
+// the G4 random stream of the event, as the particle gun depends on it only. Same settings as Gen/P8generic
+// (filter) and Gen/P8ptcgen (particle gun); HepMC output only when sHepMCPath is set.
+class Pythia8G4Generator : public G4VPrimaryGenerator {
+public:
+  Pythia8G4Generator(G4int seed);
+  virtual ~Pythia8G4Generator();
+
+  // false, with the event flagged aborted, if Pythia failed Main:timesAllowErrors times in a row
+  // or an LHE input ran out (which also ends the run)
+  G4bool GenerateEvent(G4Event* anEvent, G4int idx);
+  virtual void GeneratePrimaryVertex(G4Event* anEvent) { GenerateEvent(anEvent,anEvent->GetEventID()); }
+
+  static G4String sMode;      // generic or ptcgun
+  static G4String sCmndFile;  // Pythia8 settings, e.g. Gen/generic.cmnd or Gen/ptcgun.cmnd
+  static G4String sHepMCPath; // writes <path>_t<thread>_<seed>.root if not empty
+
+private:
+  G4bool next();
+  G4bool hasFinalState() const;
+  void Pythia2Vertices(const G4VSolid* world);
+
+  Pythia8::Pythia* fPythia;
+  P8filter* fFilter;
+  P8ptcgun* fPtcgun;
+  HepMC3::Pythia8ToHepMC3* fToHepMC;
+  HepMC3::WriterRootTree* fWriter;
+
+  G4bool fUseGun;
+  G4bool fAtRest;
+  G4bool fColSinglet;
+  G4double fScale;
+  G4int fNAbort;
+
+  std::vector<HepMCG4Vertex> fVertices;
+  HepMCG4VertexLookup fVertexLookup;
+};
+
+#endif
@@ -24,6 +24,7 @@ public:
   void SetPMTT(G4double PMTT) { fPMTT = PMTT; }
   void SetReflectorT(G4double ReflectorT) { fReflectorT = ReflectorT; }
   void SetisModule(G4bool isModule) { fisModule = isModule; }
+  void SetModuleSize(G4double moduleH, G4double moduleW) { fModuleH = moduleH; fModuleW = moduleW; }
 
   G4ThreeVector GetOrigin(G4int i);
   G4double GetX(G4int i);
@@ -45,6 +46,8 @@ private:
   G4double fPMTT;
   G4double fReflectorT;
   G4bool fisModule;
+  G4double fModuleH;
+  G4double fModuleW;
 
   G4double x,y,z;
 
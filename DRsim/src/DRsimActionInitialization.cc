@@ -3,6 +3,12 @@
 #include "DRsimRunAction.hh"
 #include "DRsimEventAction.hh"
 #include "DRsimSteppingAction.hh"
+#include "DRsimStackingAction.hh"
+#include "DRsimPhotonLUT.hh"
+#include "DRsimSiPMSD.hh"
+#ifdef DRSIM_WITH_PYTHIA8
+#include "Pythia8G4Generator.hh"
+#endif
 
 #include "G4GenericMessenger.hh"
 
@@ -12,6 +18,7 @@ DRsimActionInitialization::DRsimActionInitialization(G4int seed, G4String filena
 {
   fSeed = seed;
   fFilename = filename;
+  fUsePythia = false;
 
   DefineCommands();
 }
@@ -25,13 +32,14 @@ void DRsimActionInitialization::BuildForMaster() const {
 }
 
 void DRsimActionInitialization::Build() const {
-  SetUserAction(new DRsimPrimaryGeneratorAction(fSeed,fUseHepMC,fUseCalib,fUseGPS));
+  SetUserAction(new DRsimPrimaryGeneratorAction(fSeed,fUseHepMC,fUseCalib,fUseGPS,fUsePythia));
   SetUserAction(new DRsimRunAction(fSeed,fFilename,fUseHepMC));
 
   DRsimEventAction* eventAction = new DRsimEventAction();
   SetUserAction(eventAction);
 
   SetUserAction(new DRsimSteppingAction(eventAction));
+  SetUserAction(new DRsimStackingAction(eventAction));
 }
 
 void DRsimActionInitialization::DefineCommands() {
@@ -40,6 +48,29 @@ void DRsimActionInitialization::DefineCommands() {
   ioCmd.SetParameterName("useHepMC",true);
   ioCmd.SetDefaultValue("False");
 
+  G4GenericMessenger::Command& pythiaCmd = fMessenger->DeclareProperty("usePythia",fUsePythia,"generate the primaries with Pythia8 in each worker thread (needs DRSIM_WITH_PYTHIA8)");
+  pythiaCmd.SetParameterName("usePythia",true);
+  pythiaCmd.SetDefaultValue("False");
+
+#ifdef DRSIM_WITH_PYTHIA8
+  G4GenericMessenger::Command& pythiaModeCmd = fMessenger->DeclareProperty("pythiaMode",Pythia8G4Generator::sMode,"generic (P8generic, with P8filter) or ptcgun (P8ptcgen)");
+  pythiaModeCmd.SetParameterName("pythiaMode",true);
+  pythiaModeCmd.SetCandidates("generic ptcgun");
+  pythiaModeCmd.SetDefaultValue("ptcgun");
+
+  G4GenericMessenger::Command& pythiaCmndCmd = fMessenger->DeclareProperty("pythiaCmnd",Pythia8G4Generator::sCmndFile,"Pythia8 settings file");
+  pythiaCmndCmd.SetParameterName("pythiaCmnd",true);
+  pythiaCmndCmd.SetDefaultValue("ptcgun.cmnd");
+
+  G4GenericMessenger::Command& pythiaHepMCCmd = fMessenger->DeclareProperty("pythiaHepMC",Pythia8G4Generator::sHepMCPath,"also write the Pythia8 events to <path>_t<thread>_<seed>.root, empty : no file");
+  pythiaHepMCCmd.SetParameterName("pythiaHepMC",true);
+  pythiaHepMCCmd.SetDefaultValue("");
+#endif
+
+  G4GenericMessenger::Command& perThreadCmd = fMessenger->DeclareProperty("perThreadOutput",DRsimRunAction::sPerThreadOutput,"write one file per worker thread (merge with mergeDRsim)");
+  perThreadCmd.SetParameterName("perThreadOutput",true);
+  perThreadCmd.SetDefaultValue("False");
+
   G4GenericMessenger::Command& calibCmd = fMessenger->DeclareProperty("useCalib",fUseCalib,"use Calib");
   calibCmd.SetParameterName("useCalib",true);
   calibCmd.SetDefaultValue("False");
@@ -47,4 +78,46 @@ void DRsimActionInitialization::DefineCommands() {
   G4GenericMessenger::Command& gpsCmd = fMessenger->DeclareProperty("useGPS",fUseGPS,"use GPS");
   gpsCmd.SetParameterName("useGPS",true);
   gpsCmd.SetDefaultValue("False");
+
+  G4GenericMessenger::Command& v2Cmd = fMessenger->DeclareProperty("useV2",DRsimRunAction::sUseV2,"write the columnar (v2) event layout");
+  v2Cmd.SetParameterName("useV2",true);
+  v2Cmd.SetDefaultValue("False");
+
+  G4GenericMessenger::Command& bufCmd = fMessenger->DeclareProperty("writerBuffer",DRsimRunAction::sWriterBuffer,"max. number of events held for ordered writing");
+  bufCmd.SetParameterName("writerBuffer",true);
+  bufCmd.SetDefaultValue("64");
+
+  G4GenericMessenger::Command& prescaleCmd = fMessenger->DeclareProperty("photonPrescale",DRsimStackingAction::sPhotonPrescale,"track one in N optical photons, SiPM counts are weighted by N");
+  prescaleCmd.SetParameterName("photonPrescale",true);
+  prescaleCmd.SetRange("photonPrescale>=1");
+  prescaleCmd.SetDefaultValue("1");
+
+  G4GenericMessenger::Command& earlyKillCmd = fMessenger->DeclareProperty("earlyKill",DRsimStackingAction::sEarlyKill,"kill optical photons that cannot reach a SiPM before tracking them");
+  earlyKillCmd.SetParameterName("earlyKill",true);
+  earlyKillCmd.SetDefaultValue("False");
+
+  G4GenericMessenger::Command& statsCmd = fMessenger->DeclareProperty("photonStats",DRsimEventAction::sPhotonStats,"print tracked/killed photons and steps/s per event and per run");
+  statsCmd.SetParameterName("photonStats",true);
+  statsCmd.SetDefaultValue("False");
+
+  G4GenericMessenger::Command& lutCmd = fMessenger->DeclareProperty("photonLUT",DRsimPhotonLUT::sMode,"fiber photon LUT : off, calibrate (fill from optical transport) or use (optical physics off), set before /run/initialize");
+  lutCmd.SetParameterName("photonLUT",true);
+  lutCmd.SetCandidates("off calibrate use");
+  lutCmd.SetDefaultValue("off");
+
+  G4GenericMessenger::Command& lutFileCmd = fMessenger->DeclareProperty("photonLUTFile",DRsimPhotonLUT::sFilename,"photon LUT written by calibrate, read by use; relative to the directory DRsim runs in");
+  lutFileCmd.SetParameterName("photonLUTFile",true);
+  lutFileCmd.SetDefaultValue("photonLUT.bin");
+
+  G4GenericMessenger::Command& recordCmd = fMessenger->DeclareProperty("recordSiPM",DRsimSiPMSD::sRecordPath,"write the detected photons (module, SiPM, time, energy) to <path>_t<thread>.bin, empty : no file");
+  recordCmd.SetParameterName("recordSiPM",true);
+  recordCmd.SetDefaultValue("");
+
+  G4GenericMessenger::Command& benchSiPMCmd = fMessenger->DeclareMethod("benchmarkSiPM",&DRsimActionInitialization::BenchmarkSiPM,"replay a photon stream written by recordSiPM through the SiPM hit lookup, linear scan vs dense index");
+  benchSiPMCmd.SetParameterName("file",false);
+  benchSiPMCmd.command->SetToBeBroadcasted(false);
+}
+
+void DRsimActionInitialization::BenchmarkSiPM(G4String filename) {
+  DRsimSiPMSD::Benchmark(filename);
 }
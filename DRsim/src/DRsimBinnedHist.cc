@@ -0,0 +1,35 @@
+#include "DRsimBinnedHist.hh"
+
+#include <algorithm>
+
+DRsimBinnedHist::DRsimBinnedHist()
+: fNbin(0), fStart(0.), fStep(0.)
+{}
+
+DRsimBinnedHist::DRsimBinnedHist(G4int nBin, G4float start, G4float step)
+: fNbin(nBin), fStart(start), fStep(step), fCounts(nBin+2,0)
+{}
+
+void DRsimBinnedHist::Reset() {
+  std::fill(fCounts.begin(),fCounts.end(),0);
+}
+
+DRsimInterface::hitRange DRsimBinnedHist::GetRange(G4int bin) const {
+  // sentinel bins are open-ended: (0, edge) below the axis, (edge, 99999) above it
+  if (bin==0) return fStep > 0. ? std::make_pair(0.f,GetEdge(0)) : std::make_pair(GetEdge(0),99999.f);
+  if (bin==fNbin+1) return fStep > 0. ? std::make_pair(GetEdge(fNbin),99999.f) : std::make_pair(0.f,GetEdge(fNbin));
+
+  G4float lo = GetEdge(bin-1);
+  G4float hi = GetEdge(bin);
+
+  return fStep > 0. ? std::make_pair(lo,hi) : std::make_pair(hi,lo);
+}
+
+std::map<DRsimInterface::hitRange, int> DRsimBinnedHist::ToMap() const {
+  std::map<DRsimInterface::hitRange, int> out;
+  for (G4int i = 0; i < fNbin+2; i++) {
+    if (fCounts[i] > 0) out.insert(std::make_pair(GetRange(i),fCounts[i]));
+  }
+
+  return out;
+}
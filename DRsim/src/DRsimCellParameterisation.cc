@@ -7,18 +7,18 @@
 #include "G4VisAttributes.hh"
 #include "G4Colour.hh"
 
-DRsimCellParameterisation::DRsimCellParameterisation(const G4int numx, const G4int numy)
+DRsimCellParameterisation::DRsimCellParameterisation(const DRsimGeometryDescriptor& geom)
 : G4VPVParameterisation()
 {
-  for (G4int copyNo = 0; copyNo < numx * numy; copyNo++ ) {
-    G4int column = copyNo / numy;
-    G4int row = copyNo % numy;
+  for (G4int copyNo = 0; copyNo < geom.nofPlate*geom.nofFiber; copyNo++ ) {
+    G4int column = copyNo / geom.nofFiber;
+    G4int row = copyNo % geom.nofFiber;
     
-    fXCell.push_back( -90.*mm/2 + column*1.5*mm + 0.75*mm );
-    fYCell.push_back( -90.*mm/2 + row*1.5*mm + 0.75*mm );
+    fXCell.push_back( geom.FiberX(column) );
+    fYCell.push_back( geom.FiberY(row) );
   }
-  fNumx = numx;
-  fNumy = numy;
+  fNumx = geom.nofPlate;
+  fNumy = geom.nofFiber;
 }
 
 DRsimCellParameterisation::~DRsimCellParameterisation()
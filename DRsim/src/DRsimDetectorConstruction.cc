@@ -3,6 +3,13 @@
 #include "DRsimFilterParameterisation.hh"
 #include "DRsimMirrorParameterisation.hh"
 #include "DRsimSiPMSD.hh"
+#include "DRsimNavigationBenchmark.hh"
+#include "DRsimGeometryCache.hh"
+#include "DRsimFastOpticalModel.hh"
+#include "DRsimFiberSD.hh"
+#include "DRsimPhotonLUT.hh"
+#include "DRsimPropertyTable.hh"
+#include "DRsimPhysicsProfile.hh"
 
 #include "G4VPhysicalVolume.hh"
 #include "G4PVPlacement.hh"
@@ -16,12 +23,19 @@
 #include "G4SolidStore.hh"
 #include "G4PhysicalVolumeStore.hh"
 #include "G4GeometryManager.hh"
+#include "G4Timer.hh"
+#include "G4Region.hh"
+#include "G4RegionStore.hh"
+#include "G4ProductionCuts.hh"
 
 #include "G4Colour.hh"
 #include "G4SystemOfUnits.hh"
 
 #include "Randomize.hh"
 
+#include <cstdint>
+#include <sstream>
+
 using namespace std;
 
 G4ThreadLocal DRsimMagneticField* DRsimDetectorConstruction::fMagneticField = 0;
@@ -29,9 +43,11 @@ G4ThreadLocal G4FieldManager* DRsimDetectorConstruction::fFieldMgr = 0;
 
 int DRsimDetectorConstruction::fNofRow = 7;
 int DRsimDetectorConstruction::fNofModules = fNofRow * fNofRow;
+bool DRsimDetectorConstruction::fHasReflector = false;
 
 DRsimDetectorConstruction::DRsimDetectorConstruction()
-: G4VUserDetectorConstruction(), fMessenger(0), fMaterials(NULL) {
+: G4VUserDetectorConstruction(), fMessenger(0), fMaterials(NULL), fSharedFiber(false),
+fFastOptical(false), fPropertyPoints(0), fModuleSmartless(-1.), fModuleOptimise(true), fBenchModule(-1), fBenchPhysicsStep(1.*mm), worldLogical(0), worldPhysical(0) {
   DefineCommands();
   DefineMaterials();
 
@@ -95,28 +111,80 @@ G4VPhysicalVolume* DRsimDetectorConstruction::Construct() {
 
   checkOverlaps = false;
 
-  G4VSolid* worldSolid             = new G4Box("worldBox",10.*m,10.*m,10.*m);
-  worldLogical                     = new G4LogicalVolume(worldSolid,FindMaterial("G4_Galactic"),"worldLogical");
-  G4VPhysicalVolume* worldPhysical = new G4PVPlacement(0,G4ThreeVector(),worldLogical,"worldPhysical",0,false,0,checkOverlaps);
+  G4Timer timer;
+  timer.Start();
 
-  fFrontL     = 1500.;     // NOTE :: Length from the center of world box to center of module
-  fTowerDepth = 2500.; 
-  fModuleH    = 90;
-  fModuleW    = 90;
+  fGeom.Validate(clad_C_rMax,PMTT+filterT+reflectorT);
+  fGeom.Print();
+
+  // both work on optical photons, which only the full-optical profile produces
+  if ( !DRsimPhysicsProfile::HasOptical() ) {
+    if ( DRsimPhotonLUT::IsCalibrating() )
+      G4Exception("DRsimDetectorConstruction::Construct()", "DRsimCode008", JustWarning, ("/DRsim/action/photonLUT calibrate with the "+DRsimPhysicsProfile::sProfile+" profile, the LUT will stay empty").c_str());
+    if ( fFastOptical )
+      G4Exception("DRsimDetectorConstruction::Construct()", "DRsimCode008", JustWarning, ("/DRsim/geometry/fastOptical with the "+DRsimPhysicsProfile::sProfile+" profile, there are no optical photons to transport").c_str());
+  }
+
+  fNofRow     = fGeom.nofRow;
+  fNofModules = fGeom.NofModules();
+
+  fFrontL     = fGeom.frontL;     // NOTE :: Length from the center of world box to center of module
+  fTowerDepth = fGeom.towerDepth; 
+  DRsimPhotonLUT::sFiberLength = fTowerDepth;
+  fModuleH    = fGeom.moduleH;
+  fModuleW    = fGeom.moduleW;
   fFiberUnitH = 1.;
 
+  ModuleLogical.assign(fNofModules,0);
+  PMTGLogical.assign(fNofModules,0);
+  PMTcathLogical.assign(fNofModules,0);
+  PMTcellLogical.assign(fNofModules,0);
+  PMTfilterLogical.assign(fNofModules,0);
+  ReflectorMirrorLogical.assign(fNofModules,0);
+  fiberUnitIntersection.assign(fNofModules,std::vector<G4LogicalVolume*>());
+  fiberCladIntersection.assign(fNofModules,std::vector<G4LogicalVolume*>());
+  fiberCoreIntersection.assign(fNofModules,std::vector<G4LogicalVolume*>());
+  fModuleProp.clear();
+
 
   // fRandomSeed = 1;
 
   doFiber     = true;
   doReflector = false;
   doPMT       = true;
+  fHasReflector = doReflector;
+
+  // per-fiber Boolean volumes have no unique names, only the shared fiber mode is cached
+  if ( !fCacheDir.empty() && !fSharedFiber )
+    G4Exception("DRsimDetectorConstruction::Construct()", "DRsimCode005", JustWarning, "/DRsim/geometry/cacheDir needs /DRsim/geometry/sharedFiber True, the geometry is built without the cache");
+
+  G4String cacheBase = ( !fCacheDir.empty() && fSharedFiber ) ? fCacheDir+"/DRsimGeom_"+GeometryHash() : G4String("");
+
+  if ( !cacheBase.empty() ) {
+    DRsimGeometryCache cache(cacheBase);
+
+    if ( cache.Exists() && (worldPhysical = cache.Load(fMaterials)) ) {
+      RestoreFromCache(cache);
+      RegionsBuild();
+
+      timer.Stop();
+      G4cout << "DRsimDetectorConstruction: geometry loaded from " << cacheBase << ".gdml in " << timer.GetRealElapsed() << " s" << G4endl;
+
+      return worldPhysical;
+    }
+  }
+
+  G4VSolid* worldSolid             = new G4Box("worldBox",DRsimGeometryDescriptor::worldHalf,DRsimGeometryDescriptor::worldHalf,DRsimGeometryDescriptor::worldHalf);
+  worldLogical                     = new G4LogicalVolume(worldSolid,FindMaterial("G4_Galactic"),"worldLogical");
+  worldPhysical                    = new G4PVPlacement(0,G4ThreeVector(),worldLogical,"worldPhysical",0,false,0,checkOverlaps);
 
   fiberUnit   = new G4Box("fiber_SQ", (fFiberUnitH/2) *mm, (1./2) *mm, (fTowerDepth/2) *mm);
   fiberClad   = new G4Tubs("fiber",  0, clad_C_rMax, fTowerDepth/2., 0 *deg, 360. *deg);   // S is the same
   fiberCoreC  = new G4Tubs("fiberC", 0, core_C_rMax, fTowerDepth/2., 0 *deg, 360. *deg);
   fiberCoreS  = new G4Tubs("fiberS", 0, core_S_rMax, fTowerDepth/2., 0 *deg, 360. *deg);
 
+  if ( doFiber && fSharedFiber ) SharedFiberBuild();
+
   dimCalc = new dimensionCalc();
   dimCalc->SetFrontL(fFrontL);
   dimCalc->SetTower_height(fTowerDepth);
@@ -124,13 +192,62 @@ G4VPhysicalVolume* DRsimDetectorConstruction::Construct() {
   dimCalc->SetReflectorT(reflectorT);
   dimCalc->SetNofModules(fNofModules);
   dimCalc->SetNofRow(fNofRow);
+  dimCalc->SetModuleSize(fModuleH,fModuleW);
 
   ModuleBuild(ModuleLogical,PMTGLogical,PMTfilterLogical,PMTcellLogical,PMTcathLogical,ReflectorMirrorLogical,fiberUnitIntersection,fiberCladIntersection,fiberCoreIntersection,fModuleProp);
 
   delete dimCalc;
+
+  if ( !cacheBase.empty() ) DRsimGeometryCache(cacheBase).Save(worldPhysical,fModuleProp,PMTcathLogical);
+  RegionsBuild();
+
+  timer.Stop();
+  G4cout << "DRsimDetectorConstruction: geometry built in " << timer.GetRealElapsed() << " s" << G4endl;
+
   return worldPhysical;
 }
 
+G4String DRsimDetectorConstruction::GeometryHash() const {
+  // everything Construct() depends on; bump the version when the construction code changes
+  std::ostringstream params;
+  params << "v2 " << fGeom.nofRow << " " << fGeom.nofPlate << " " << fGeom.nofFiber << " " << fGeom.fiberPitch << " "
+         << fGeom.moduleH << " " << fGeom.moduleW << " " << fGeom.towerDepth << " " << fGeom.frontL << " "
+         << doFiber << doReflector << doPMT << fSharedFiber << " "
+         << clad_C_rMax << " " << core_C_rMax << " " << core_S_rMax << " " << PMTT << " " << filterT << " " << reflectorT;
+
+  // FNV-1a, stable across builds unlike std::hash
+  std::uint64_t hash = 14695981039346656037ULL;
+  for (char c : params.str()) {
+    hash ^= (unsigned char)c;
+    hash *= 1099511628211ULL;
+  }
+
+  std::ostringstream hex;
+  hex << std::hex << hash;
+  return hex.str();
+}
+
+void DRsimDetectorConstruction::RestoreFromCache(const DRsimGeometryCache& cache) {
+  worldLogical = worldPhysical->GetLogicalVolume();
+  fModuleProp = cache.GetModuleProp();
+
+  G4LogicalVolumeStore* lvStore = G4LogicalVolumeStore::GetInstance();
+
+  for (int i = 0; i < fNofModules; i++) {
+    ModuleLogical[i] = lvStore->GetVolume(setModuleName(i),false);
+    if ( ModuleLogical[i] ) {
+      ModuleLogical[i]->SetOptimisation(fModuleOptimise);
+      if ( fModuleSmartless > 0. ) ModuleLogical[i]->SetSmartless(fModuleSmartless);
+    }
+  }
+
+  for (unsigned int i = 0; i < fModuleProp.size(); i++) {
+    PMTcathLogical.at(fModuleProp.at(i).ModuleNum) = lvStore->GetVolume(cache.GetCathodeNames().at(i),false);
+  }
+
+  if ( !fModuleProp.empty() ) fTowerXY = fModuleProp.front().towerXY;
+}
+
 void DRsimDetectorConstruction::ConstructSDandField() {
   G4SDManager* SDman = G4SDManager::GetSDMpointer();
   G4String SiPMName = "SiPMSD";
@@ -143,12 +260,69 @@ void DRsimDetectorConstruction::ConstructSDandField() {
       PMTcathLogical[i]->SetSensitiveDetector(SiPMSDmodule);
     }
   }
+
+  // one model per thread, the SDs above are looked up by name on first use
+  // calibrating the photon LUT needs the full optical transport
+  G4Region* fiberCoreRegion = G4RegionStore::GetInstance()->GetRegion("FiberCore",false);
+  G4double SiPMz = fTowerDepth/2. + PMTT + filterT/2.; // cathode center in the module frame
+  if ( fFastOptical && doPMT && fiberCoreRegion && !DRsimPhotonLUT::IsCalibrating() ) {
+    new DRsimFastOpticalModel("DRsimFastOptical",fiberCoreRegion,fGeom.nofFiber,fTowerDepth/2.,SiPMz,doReflector,fPropertyPoints);
+  }
+
+  if ( DRsimPhotonLUT::sMode!="off" && doPMT && fiberCoreRegion ) {
+    DRsimFiberSD* fiberSD = new DRsimFiberSD("FiberSD",fGeom.nofFiber,fTowerDepth/2.,SiPMz);
+    SDman->AddNewDetector(fiberSD);
+
+    std::vector<G4LogicalVolume*>::iterator lvIt = fiberCoreRegion->GetRootLogicalVolumeIterator();
+    for (size_t ilv = 0; ilv < fiberCoreRegion->GetNumberOfRootVolumes(); ilv++, lvIt++) (*lvIt)->SetSensitiveDetector(fiberSD);
+  }
+}
+
+void DRsimDetectorConstruction::RegionsBuild() {
+  // copper modules, the fibers inherit it except for the cores
+  G4Region* absorber = G4RegionStore::GetInstance()->GetRegion("Absorber",false);
+  if (!absorber) absorber = new G4Region("Absorber");
+  for (auto lv : ModuleLogical) absorber->AddRootLogicalVolume(lv);
+
+  FiberCoreRegionBuild();
+  G4Region* fiberCore = G4RegionStore::GetInstance()->GetRegion("FiberCore",false);
+
+  SetRegionCut(absorber,DRsimPhysicsProfile::sAbsorberCut);
+  SetRegionCut(fiberCore,DRsimPhysicsProfile::sFiberCoreCut);
+}
+
+void DRsimDetectorConstruction::SetRegionCut(G4Region* region, G4double cut) {
+  // without own cuts the run manager hands the region the default (world) cuts;
+  // those are shared, hence a fresh object instead of changing the current one
+  if ( cut <= 0. ) {
+    region->SetProductionCuts(0);
+    return;
+  }
+
+  G4ProductionCuts* cuts = new G4ProductionCuts();
+  cuts->SetProductionCut(cut);
+  region->SetProductionCuts(cuts);
+}
+
+void DRsimDetectorConstruction::FiberCoreRegionBuild() {
+  G4Region* region = G4RegionStore::GetInstance()->GetRegion("FiberCore",false);
+  if (!region) region = new G4Region("FiberCore");
+
+  G4LogicalVolumeStore* lvStore = G4LogicalVolumeStore::GetInstance();
+  for (auto lv : *lvStore) {
+    // shared fiber cores, or the per-fiber Boolean cores
+    if ( lv->GetName()=="fiberCoreC" || lv->GetName()=="fiberCoreS" ) region->AddRootLogicalVolume(lv);
+  }
+
+  for (const auto& cores : fiberCoreIntersection) {
+    for (auto lv : cores) region->AddRootLogicalVolume(lv);
+  }
 }
 
-void DRsimDetectorConstruction::ModuleBuild(G4LogicalVolume* ModuleLogical_[], 
-                                            G4LogicalVolume* PMTGLogical_[], G4LogicalVolume* PMTfilterLogical_[], G4LogicalVolume* PMTcellLogical_[], G4LogicalVolume* PMTcathLogical_[], 
-                                            G4LogicalVolume* ReflectorMirrorLogical_[],
-                                            std::vector<G4LogicalVolume*> fiberUnitIntersection_[], std::vector<G4LogicalVolume*> fiberCladIntersection_[], std::vector<G4LogicalVolume*> fiberCoreIntersection_[], 
+void DRsimDetectorConstruction::ModuleBuild(std::vector<G4LogicalVolume*>& ModuleLogical_, 
+                                            std::vector<G4LogicalVolume*>& PMTGLogical_, std::vector<G4LogicalVolume*>& PMTfilterLogical_, std::vector<G4LogicalVolume*>& PMTcellLogical_, std::vector<G4LogicalVolume*>& PMTcathLogical_, 
+                                            std::vector<G4LogicalVolume*>& ReflectorMirrorLogical_,
+                                            std::vector<std::vector<G4LogicalVolume*>>& fiberUnitIntersection_, std::vector<std::vector<G4LogicalVolume*>>& fiberCladIntersection_, std::vector<std::vector<G4LogicalVolume*>>& fiberCoreIntersection_, 
                                             std::vector<DRsimInterface::DRsimModuleProperty>& ModuleProp_) {
 
   for (int i = 0; i < fNofModules; i++) {    
@@ -157,14 +331,17 @@ void DRsimDetectorConstruction::ModuleBuild(G4LogicalVolume* ModuleLogical_[],
     dimCalc->SetisModule(true);
     module = new G4Box("Mudule", (fModuleH/2.) *mm, (fModuleW/2.) *mm, (fTowerDepth/2.) *mm );
     ModuleLogical_[i] = new G4LogicalVolume(module,FindMaterial("Copper"),moduleName);
-    // G4VPhysicalVolume* modulePhysical = new G4PVPlacement(0,dimCalc->GetOrigin(i),ModuleLogical_[i],moduleName,worldLogical,false,0,checkOverlaps);
-    new G4PVPlacement(0,dimCalc->GetOrigin(i),ModuleLogical_[i],moduleName,worldLogical,false,0,checkOverlaps);
+    ModuleLogical_[i]->SetOptimisation(fModuleOptimise);
+    if ( fModuleSmartless > 0. ) ModuleLogical_[i]->SetSmartless(fModuleSmartless);
+    // G4VPhysicalVolume* modulePhysical = new G4PVPlacement(0,dimCalc->GetOrigin(i),ModuleLogical_[i],moduleName,worldLogical,false,i,checkOverlaps);
+    // copy number carries the module number, DRsimSteppingAction relies on it
+    new G4PVPlacement(0,dimCalc->GetOrigin(i),ModuleLogical_[i],moduleName,worldLogical,false,i,checkOverlaps);
 
     if ( doPMT ) {
       dimCalc->SetisModule(false);  
       pmtg = new G4Box("PMTG", (fModuleH/2.) *mm, (fModuleW/2.) *mm, (PMTT+filterT)/2. *mm );
-      PMTGLogical_[i]  = new G4LogicalVolume(pmtg,FindMaterial("G4_AIR"),moduleName);
-      new G4PVPlacement(0,dimCalc->GetOrigin_PMTG(i),PMTGLogical_[i],moduleName,worldLogical,false,0,checkOverlaps);
+      PMTGLogical_[i]  = new G4LogicalVolume(pmtg,FindMaterial("G4_AIR"),moduleName+"PMTG");
+      new G4PVPlacement(0,dimCalc->GetOrigin_PMTG(i),PMTGLogical_[i],moduleName,worldLogical,false,i,checkOverlaps);
     }
 
     FiberImplement(i,ModuleLogical_,fiberUnitIntersection_,fiberCladIntersection_,fiberCoreIntersection_);
@@ -176,29 +353,29 @@ void DRsimDetectorConstruction::ModuleBuild(G4LogicalVolume* ModuleLogical_[],
 
     if ( doPMT ) {
       G4VSolid* SiPMlayerSolid = new G4Box("SiPMlayerSolid", (fModuleH/2.) *mm, (fModuleW/2.) *mm, (PMTT/2.) *mm );
-      G4LogicalVolume* SiPMlayerLogical = new G4LogicalVolume(SiPMlayerSolid,FindMaterial("G4_AIR"),"SiPMlayerLogical");
+      G4LogicalVolume* SiPMlayerLogical = new G4LogicalVolume(SiPMlayerSolid,FindMaterial("G4_AIR"),"SiPMlayerLogical_"+std::to_string(i));
       new G4PVPlacement(0,G4ThreeVector(0.,0.,filterT/2.),SiPMlayerLogical,"SiPMlayerPhysical",PMTGLogical_[i],false,0,checkOverlaps);
 
       G4VSolid* filterlayerSolid = new G4Box("filterlayerSolid", (fModuleH/2.) *mm, (fModuleW/2.) *mm, (filterT/2.) *mm );
-      G4LogicalVolume* filterlayerLogical = new G4LogicalVolume(filterlayerSolid,FindMaterial("Glass"),"filterlayerLogical");
+      G4LogicalVolume* filterlayerLogical = new G4LogicalVolume(filterlayerSolid,FindMaterial("Glass"),"filterlayerLogical_"+std::to_string(i));
       new G4PVPlacement(0,G4ThreeVector(0.,0.,-PMTT/2.),filterlayerLogical,"filterlayerPhysical",PMTGLogical_[i],false,0,checkOverlaps);
 
-      G4VSolid* PMTcellSolid = new G4Box("PMTcellSolid", 1.2/2. *mm, 1.2/2. *mm, PMTT/2. *mm );
-      PMTcellLogical_[i] = new G4LogicalVolume(PMTcellSolid,FindMaterial("Glass"),"PMTcellLogical_");
+      G4VSolid* PMTcellSolid = new G4Box("PMTcellSolid", DRsimGeometryDescriptor::SiPMSize/2., DRsimGeometryDescriptor::SiPMSize/2., PMTT/2. *mm );
+      PMTcellLogical_[i] = new G4LogicalVolume(PMTcellSolid,FindMaterial("Glass"),"PMTcellLogical_"+std::to_string(i));
 
-      DRsimCellParameterisation* PMTcellParam = new DRsimCellParameterisation(fTowerXY.first,fTowerXY.second);
-      G4PVParameterised* PMTcellPhysical = new G4PVParameterised("PMTcellPhysical",PMTcellLogical_[i],SiPMlayerLogical,kXAxis,fTowerXY.first*fTowerXY.second,PMTcellParam);
+      DRsimCellParameterisation* PMTcellParam = new DRsimCellParameterisation(fGeom);
+      G4PVParameterised* PMTcellPhysical = new G4PVParameterised("PMTcellPhysical_"+std::to_string(i),PMTcellLogical_[i],SiPMlayerLogical,kXAxis,PMTcellParam->GetNofCopies(),PMTcellParam);
 
-      G4VSolid* PMTcathSolid = new G4Box("PMTcathSolid", 1.2/2. *mm, 1.2/2. *mm, filterT/2. *mm );
-      PMTcathLogical_[i] = new G4LogicalVolume(PMTcathSolid,FindMaterial("Silicon"),"PMTcathLogical_");
+      G4VSolid* PMTcathSolid = new G4Box("PMTcathSolid", DRsimGeometryDescriptor::SiPMSize/2., DRsimGeometryDescriptor::SiPMSize/2., filterT/2. *mm );
+      PMTcathLogical_[i] = new G4LogicalVolume(PMTcathSolid,FindMaterial("Silicon"),"PMTcathLogical_"+std::to_string(i));
       new G4PVPlacement(0,G4ThreeVector(0.,0.,(PMTT-filterT)/2.*mm),PMTcathLogical_[i],"PMTcathPhysical",PMTcellLogical_[i],false,0,checkOverlaps);
       new G4LogicalSkinSurface("Photocath_surf",PMTcathLogical_[i],FindSurface("SiPMSurf"));
 
-      G4VSolid* filterSolid = new G4Box("filterSolid", 1.2/2. *mm, 1.2/2. *mm, filterT/2. *mm );
-      PMTfilterLogical_[i] = new G4LogicalVolume(filterSolid,FindMaterial("Gelatin"),"PMTfilterLogical_");
+      G4VSolid* filterSolid = new G4Box("filterSolid", DRsimGeometryDescriptor::SiPMSize/2., DRsimGeometryDescriptor::SiPMSize/2., filterT/2. *mm );
+      PMTfilterLogical_[i] = new G4LogicalVolume(filterSolid,FindMaterial("Gelatin"),"PMTfilterLogical_"+std::to_string(i));
 
-      DRsimFilterParameterisation* filterParam = new DRsimFilterParameterisation(fTowerXY.first,fTowerXY.second);
-      G4PVParameterised* filterPhysical = new G4PVParameterised("filterPhysical",PMTfilterLogical_[i],filterlayerLogical,kXAxis,fTowerXY.first*fTowerXY.second/2,filterParam);
+      DRsimFilterParameterisation* filterParam = new DRsimFilterParameterisation(fGeom);
+      G4PVParameterised* filterPhysical = new G4PVParameterised("filterPhysical_"+std::to_string(i),PMTfilterLogical_[i],filterlayerLogical,kXAxis,filterParam->GetNofCopies(),filterParam);
       new G4LogicalBorderSurface("filterSurf",filterPhysical,PMTcellPhysical,FindSurface("FilterSurf"));
           
       PMTcathLogical_[i]->SetVisAttributes(fVisAttrGreen);
@@ -207,14 +384,15 @@ void DRsimDetectorConstruction::ModuleBuild(G4LogicalVolume* ModuleLogical_[],
 
     if ( doReflector ) {
       G4VSolid* ReflectorlayerSolid = new G4Box("ReflectorlayerSolid", (fModuleH/2.) *mm, (fModuleW/2.) *mm, (reflectorT/2.) *mm );
-      G4LogicalVolume* ReflectorlayerLogical = new G4LogicalVolume(ReflectorlayerSolid,FindMaterial("G4_Galactic"),"ReflectorlayerLogical");
-      new G4PVPlacement(0,dimCalc->GetOrigin_Reflector(i),ReflectorlayerLogical,"ReflectorlayerPhysical",worldLogical,false,0,checkOverlaps);
+      G4LogicalVolume* ReflectorlayerLogical = new G4LogicalVolume(ReflectorlayerSolid,FindMaterial("G4_Galactic"),"ReflectorlayerLogical_"+std::to_string(i));
+      // module number as copy number, like the module and PMTG placements
+      new G4PVPlacement(0,dimCalc->GetOrigin_Reflector(i),ReflectorlayerLogical,"ReflectorlayerPhysical",worldLogical,false,i,checkOverlaps);
 
-      G4VSolid* mirrorSolid = new G4Box("mirrorSolid", 1.2/2. *mm, 1.2/2. *mm, reflectorT/2. *mm );
-      ReflectorMirrorLogical_[i] = new G4LogicalVolume(mirrorSolid,FindMaterial("Aluminum"),"ReflectorMirrorLogical_");
+      G4VSolid* mirrorSolid = new G4Box("mirrorSolid", DRsimGeometryDescriptor::SiPMSize/2., DRsimGeometryDescriptor::SiPMSize/2., reflectorT/2. *mm );
+      ReflectorMirrorLogical_[i] = new G4LogicalVolume(mirrorSolid,FindMaterial("Aluminum"),"ReflectorMirrorLogical_"+std::to_string(i));
 
-      DRsimMirrorParameterisation* mirrorParam = new DRsimMirrorParameterisation(fTowerXY.first,fTowerXY.second);
-      G4PVParameterised* mirrorPhysical = new G4PVParameterised("mirrorPhysical",ReflectorMirrorLogical_[i],ReflectorlayerLogical,kXAxis,fTowerXY.first*fTowerXY.second/2,mirrorParam);
+      DRsimMirrorParameterisation* mirrorParam = new DRsimMirrorParameterisation(fGeom);
+      G4PVParameterised* mirrorPhysical = new G4PVParameterised("mirrorPhysical",ReflectorMirrorLogical_[i],ReflectorlayerLogical,kXAxis,mirrorParam->GetNofCopies(),mirrorParam);
       // new G4LogicalBorderSurface("MirrorSurf",mirrorPhysical,modulePhysical,FindSurface("MirrorSurf"));
       new G4LogicalSkinSurface("MirrorSurf",ReflectorMirrorLogical_[i],FindSurface("MirrorSurf"));
 
@@ -223,18 +401,149 @@ void DRsimDetectorConstruction::ModuleBuild(G4LogicalVolume* ModuleLogical_[],
   }
 }
 
-void DRsimDetectorConstruction::DefineCommands() {}
+void DRsimDetectorConstruction::DefineCommands() {
+  fMessenger = new G4GenericMessenger(this, "/DRsim/geometry/", "geometry control");
+  G4GenericMessenger::Command& sharedFiberCmd = fMessenger->DeclareProperty("sharedFiber",fSharedFiber,"place shared fiber volumes instead of per-fiber Boolean solids");
+  sharedFiberCmd.SetParameterName("sharedFiber",true);
+  sharedFiberCmd.SetDefaultValue("False");
+
+  G4GenericMessenger::Command& loadCmd = fMessenger->DeclareMethod("load",&DRsimDetectorConstruction::LoadGeometry,"read the grid and fiber lattice from a text file of key value lines");
+  loadCmd.SetParameterName("filename",false);
+
+  G4GenericMessenger::Command& rowCmd = fMessenger->DeclareProperty("nofRow",fGeom.nofRow,"modules per row and column");
+  rowCmd.SetParameterName("nofRow",true);
+  rowCmd.SetDefaultValue("7");
+
+  G4GenericMessenger::Command& plateCmd = fMessenger->DeclareProperty("nofPlate",fGeom.nofPlate,"fiber columns per module");
+  plateCmd.SetParameterName("nofPlate",true);
+  plateCmd.SetDefaultValue("60");
+
+  G4GenericMessenger::Command& fiberCmd = fMessenger->DeclareProperty("nofFiber",fGeom.nofFiber,"fibers per plate");
+  fiberCmd.SetParameterName("nofFiber",true);
+  fiberCmd.SetDefaultValue("60");
+
+  G4GenericMessenger::Command& pitchCmd = fMessenger->DeclarePropertyWithUnit("fiberPitch","mm",fGeom.fiberPitch,"fiber pitch");
+  pitchCmd.SetParameterName("fiberPitch",true);
+  pitchCmd.SetDefaultValue("1.5");
+
+  G4GenericMessenger::Command& moduleHCmd = fMessenger->DeclarePropertyWithUnit("moduleH","mm",fGeom.moduleH,"module size along x");
+  moduleHCmd.SetParameterName("moduleH",true);
+  moduleHCmd.SetDefaultValue("90.");
+
+  G4GenericMessenger::Command& moduleWCmd = fMessenger->DeclarePropertyWithUnit("moduleW","mm",fGeom.moduleW,"module size along y");
+  moduleWCmd.SetParameterName("moduleW",true);
+  moduleWCmd.SetDefaultValue("90.");
+
+  G4GenericMessenger::Command& depthCmd = fMessenger->DeclarePropertyWithUnit("towerDepth","mm",fGeom.towerDepth,"module length");
+  depthCmd.SetParameterName("towerDepth",true);
+  depthCmd.SetDefaultValue("2500.");
+
+  G4GenericMessenger::Command& frontCmd = fMessenger->DeclarePropertyWithUnit("frontL","mm",fGeom.frontL,"distance of the module front face from the world center");
+  frontCmd.SetParameterName("frontL",true);
+  frontCmd.SetDefaultValue("1500.");
 
-void DRsimDetectorConstruction::FiberImplement(G4int i, G4LogicalVolume* ModuleLogical__[], 
-                                              std::vector<G4LogicalVolume*> fiberUnitIntersection__[], std::vector<G4LogicalVolume*> fiberCladIntersection__[], 
-                                              std::vector<G4LogicalVolume*> fiberCoreIntersection__[]) {
+  G4GenericMessenger::Command& fastOpticalCmd = fMessenger->DeclareMethod("fastOptical",&DRsimDetectorConstruction::SetFastOptical,"parameterised light transport for photons created in the fiber cores, set before /run/initialize");
+  fastOpticalCmd.SetParameterName("fastOptical",true);
+  fastOpticalCmd.SetDefaultValue("False");
+  fastOpticalCmd.SetStates(G4State_PreInit);
+
+  G4GenericMessenger::Command& pointsCmd = fMessenger->DeclareProperty("propertyPoints",fPropertyPoints,"pre-sample the optical properties of the fast model on N energies (0 : G4 interpolation), set before /run/initialize");
+  pointsCmd.SetParameterName("propertyPoints",true);
+  pointsCmd.SetDefaultValue("0");
+
+  G4GenericMessenger::Command& propBenchCmd = fMessenger->DeclareMethod("benchmarkProperties",&DRsimDetectorConstruction::RunPropertyBenchmark,"time N lookups of each optical property table, G4 interpolation vs pre-sampled");
+  propBenchCmd.SetParameterName("nLookup",true);
+  propBenchCmd.SetDefaultValue("10000000");
+
+  G4GenericMessenger::Command& cacheCmd = fMessenger->DeclareProperty("cacheDir",fCacheDir,"directory of the GDML geometry cache (empty : no cache)");
+  cacheCmd.SetParameterName("cacheDir",true);
+  cacheCmd.SetDefaultValue("");
+
+  G4GenericMessenger::Command& smartlessCmd = fMessenger->DeclareProperty("smartless",fModuleSmartless,"voxel smartless of the module volumes (< 0 : Geant4 default), set before /run/initialize");
+  smartlessCmd.SetParameterName("smartless",true);
+  smartlessCmd.SetDefaultValue("-1.");
+
+  G4GenericMessenger::Command& optimiseCmd = fMessenger->DeclareProperty("optimise",fModuleOptimise,"voxelize the module volumes, set before /run/initialize");
+  optimiseCmd.SetParameterName("optimise",true);
+  optimiseCmd.SetDefaultValue("True");
+
+  fMessenger->DeclareMethod("voxelStats",&DRsimDetectorConstruction::ReportVoxelStats,"rebuild the voxels and print their statistics");
+
+  G4GenericMessenger::Command& benchModuleCmd = fMessenger->DeclareProperty("benchmarkModule",fBenchModule,"module traced by /DRsim/geometry/benchmark (< 0 : central module)");
+  benchModuleCmd.SetParameterName("benchmarkModule",true);
+  benchModuleCmd.SetDefaultValue("-1");
+
+  G4GenericMessenger::Command& benchStepCmd = fMessenger->DeclarePropertyWithUnit("benchmarkPhysicsStep","mm",fBenchPhysicsStep,"mean physics step of the charged benchmark rays");
+  benchStepCmd.SetParameterName("benchmarkPhysicsStep",true);
+  benchStepCmd.SetDefaultValue("1.");
+
+  G4GenericMessenger::Command& benchCmd = fMessenger->DeclareMethod("benchmark",&DRsimDetectorConstruction::RunNavigationBenchmark,"trace N geantino and N charged rays through one module and print the navigation time per step");
+  benchCmd.SetParameterName("nRay",true);
+  benchCmd.SetDefaultValue("1000");
+}
+
+void DRsimDetectorConstruction::ReportVoxelStats() {
+  if (!worldPhysical) return;
+
+  // closing with verbose on prints the voxelization statistics
+  G4GeometryManager::GetInstance()->OpenGeometry();
+  G4GeometryManager::GetInstance()->CloseGeometry(true,true);
+}
+
+void DRsimDetectorConstruction::RunNavigationBenchmark(G4int nRay) {
+  if (!worldPhysical) {
+    G4Exception("DRsimDetectorConstruction::RunNavigationBenchmark()", "DRsimCode004", JustWarning, "geometry not constructed, run /run/initialize first");
+    return;
+  }
+
+  G4int moduleNum = ( fBenchModule >= 0 && fBenchModule < fNofModules ) ? fBenchModule : fNofModules/2;
+  G4VPhysicalVolume* modulePhysical = 0;
+
+  for (size_t i = 0; i < worldLogical->GetNoDaughters(); i++) {
+    G4VPhysicalVolume* daughter = worldLogical->GetDaughter(i);
+    if ( daughter->GetLogicalVolume()==ModuleLogical[moduleNum] ) modulePhysical = daughter;
+  }
+
+  if (!modulePhysical) return;
+
+  DRsimNavigationBenchmark benchmark(worldPhysical,modulePhysical);
+  benchmark.SetPhysicsStep(fBenchPhysicsStep);
+  benchmark.Run(nRay,false);
+  benchmark.Run(nRay,true);
+}
+
+void DRsimDetectorConstruction::SharedFiberBuild() {
+  // fibers of the same type are identical, one logical volume pair each is placed in every module.
+  // The core is the only daughter of the shared clad, so it has copy number 0 in every fiber;
+  // the fiber index j is the copy number of the clad, which is what the SDs read (GetVolume(1))
+  fiberCladCLogical = new G4LogicalVolume(fiberClad,FindMaterial("FluorinatedPolymer"),"fiberCladC");
+  fiberCoreCLogical = new G4LogicalVolume(fiberCoreC,FindMaterial("PMMA"),"fiberCoreC");
+  new G4PVPlacement(0,G4ThreeVector(0.,0.,0.),fiberCoreCLogical,"fiberCoreC",fiberCladCLogical,false,0,checkOverlaps);
+
+  fiberCladSLogical = new G4LogicalVolume(fiberClad,FindMaterial("PMMA"),"fiberCladS");
+  fiberCoreSLogical = new G4LogicalVolume(fiberCoreS,FindMaterial("Polystyrene"),"fiberCoreS");
+  new G4PVPlacement(0,G4ThreeVector(0.,0.,0.),fiberCoreSLogical,"fiberCoreS",fiberCladSLogical,false,0,checkOverlaps);
+
+  fiberCladCLogical->SetVisAttributes(fVisAttrGray);
+  fiberCoreCLogical->SetVisAttributes(fVisAttrBlue);
+  fiberCladSLogical->SetVisAttributes(fVisAttrGray);
+  fiberCoreSLogical->SetVisAttributes(fVisAttrOrange);
+}
+
+G4bool DRsimDetectorConstruction::FiberInsideModule(G4float fX, G4float fY) const {
+  return std::abs(fX) + clad_C_rMax <= fModuleH/2.*mm && std::abs(fY) + clad_C_rMax <= fModuleW/2.*mm;
+}
+
+void DRsimDetectorConstruction::FiberImplement(G4int i, std::vector<G4LogicalVolume*>& ModuleLogical__, 
+                                              std::vector<std::vector<G4LogicalVolume*>>& fiberUnitIntersection__, std::vector<std::vector<G4LogicalVolume*>>& fiberCladIntersection__, 
+                                              std::vector<std::vector<G4LogicalVolume*>>& fiberCoreIntersection__) {
 
   fFiberX.clear();
   fFiberY.clear();
   fFiberWhich.clear();
 
-  int NofFiber = 60;   
-  int NofPlate = 60;   
+  int NofFiber = fGeom.nofFiber;   
+  int NofPlate = fGeom.nofPlate;   
   double randDeviation = 0.; //  double randDeviation = fFiberUnitH - 1.;
   fTowerXY = std::make_pair(NofPlate,NofFiber);
   
@@ -244,8 +553,8 @@ void DRsimDetectorConstruction::FiberImplement(G4int i, G4LogicalVolume* ModuleL
       /*
         ? fX : # of plate , fY : # of fiber in the plate
       */
-      G4float fX = -90.*mm/2 + k*1.5*mm + 0.75*mm;
-      G4float fY = -90.*mm/2 + j*1.5*mm + 0.75*mm;
+      G4float fX = fGeom.FiberX(k);
+      G4float fY = fGeom.FiberY(j);
       fWhich = !fWhich;
       fFiberX.push_back(fX);
       fFiberY.push_back(fY);
@@ -257,33 +566,57 @@ void DRsimDetectorConstruction::FiberImplement(G4int i, G4LogicalVolume* ModuleL
   if ( doFiber ) {
     for (unsigned int j = 0; j<fFiberX.size(); j++) {
 
+      // only fibers crossing the module boundary need to be clipped by a Boolean solid
+      if ( fSharedFiber && FiberInsideModule(fFiberX.at(j),fFiberY.at(j)) ) {
+        G4LogicalVolume* cladLogical = fFiberWhich.at(j) ? fiberCladSLogical : fiberCladCLogical;
+        new G4PVPlacement(0,G4ThreeVector(fFiberX.at(j),fFiberY.at(j),0),cladLogical,cladLogical->GetName(),ModuleLogical__[i],false,j,checkOverlaps);
+
+        continue;
+      }
+
       if ( !fFiberWhich.at(j) ) { //c fibre
 
         tfiberCladIntersection = new G4IntersectionSolid("fiberClad",fiberClad,module,0,G4ThreeVector(-fFiberX.at(j),-fFiberY.at(j),0.));
         fiberCladIntersection__[i].push_back(new G4LogicalVolume(tfiberCladIntersection,FindMaterial("FluorinatedPolymer"),name));
-        new G4PVPlacement(0,G4ThreeVector(fFiberX.at(j),fFiberY.at(j),0),fiberCladIntersection__[i].at(j),name,ModuleLogical__[i],false,j,checkOverlaps);
+        new G4PVPlacement(0,G4ThreeVector(fFiberX.at(j),fFiberY.at(j),0),fiberCladIntersection__[i].back(),name,ModuleLogical__[i],false,j,checkOverlaps);
 
         tfiberCoreIntersection = new G4IntersectionSolid("fiberCore",fiberCoreC,module,0,G4ThreeVector(-fFiberX.at(j),-fFiberY.at(j),0.));
         fiberCoreIntersection__[i].push_back(new G4LogicalVolume(tfiberCoreIntersection,FindMaterial("PMMA"),name));
-        new G4PVPlacement(0,G4ThreeVector(0.,0.,0.),fiberCoreIntersection__[i].at(j),name,fiberCladIntersection__[i].at(j),false,j,checkOverlaps);
+        new G4PVPlacement(0,G4ThreeVector(0.,0.,0.),fiberCoreIntersection__[i].back(),name,fiberCladIntersection__[i].back(),false,j,checkOverlaps);
 
-        fiberCladIntersection__[i].at(j)->SetVisAttributes(fVisAttrGray);
-        fiberCoreIntersection__[i].at(j)->SetVisAttributes(fVisAttrBlue);
+        fiberCladIntersection__[i].back()->SetVisAttributes(fVisAttrGray);
+        fiberCoreIntersection__[i].back()->SetVisAttributes(fVisAttrBlue);
       } else { // s fibre
 
         tfiberCladIntersection = new G4IntersectionSolid("fiberClad",fiberClad,module,0,G4ThreeVector(-fFiberX.at(j),-fFiberY.at(j),0.));
         fiberCladIntersection__[i].push_back(new G4LogicalVolume(tfiberCladIntersection,FindMaterial("PMMA"),name));
-        new G4PVPlacement(0,G4ThreeVector(fFiberX.at(j),fFiberY.at(j),0),fiberCladIntersection__[i].at(j),name,ModuleLogical__[i],false,j,checkOverlaps);
+        new G4PVPlacement(0,G4ThreeVector(fFiberX.at(j),fFiberY.at(j),0),fiberCladIntersection__[i].back(),name,ModuleLogical__[i],false,j,checkOverlaps);
 
         tfiberCoreIntersection = new G4IntersectionSolid("fiberCore",fiberCoreS,module,0,G4ThreeVector(-fFiberX.at(j),-fFiberY.at(j),0.));
         fiberCoreIntersection__[i].push_back(new G4LogicalVolume(tfiberCoreIntersection,FindMaterial("Polystyrene"),name));
-        new G4PVPlacement(0,G4ThreeVector(0.,0.,0.),fiberCoreIntersection__[i].at(j),name,fiberCladIntersection__[i].at(j),false,j,checkOverlaps);
+        new G4PVPlacement(0,G4ThreeVector(0.,0.,0.),fiberCoreIntersection__[i].back(),name,fiberCladIntersection__[i].back(),false,j,checkOverlaps);
 
-        fiberCladIntersection__[i].at(j)->SetVisAttributes(fVisAttrGray);
-        fiberCoreIntersection__[i].at(j)->SetVisAttributes(fVisAttrOrange);
+        fiberCladIntersection__[i].back()->SetVisAttributes(fVisAttrGray);
+        fiberCoreIntersection__[i].back()->SetVisAttributes(fVisAttrOrange);
       }
     }
   }
 }
 
+void DRsimDetectorConstruction::SetFastOptical(G4bool fastOptical) {
+  fFastOptical = fastOptical;
 
+  // the model needs G4FastSimulationPhysics, which is not registered otherwise
+  if ( fFastOptical ) DRsimPhysicsProfile::RequestFastSimulation();
+}
+
+void DRsimDetectorConstruction::RunPropertyBenchmark(G4int nLookup) {
+  G4int nPoint = fPropertyPoints > 1 ? fPropertyPoints : 1024;
+
+  DRsimPropertyTable::Benchmark(FindSurface("SiPMSurf")->GetMaterialPropertiesTable()->GetProperty("EFFICIENCY"),"SiPMSurf EFFICIENCY",nPoint,nLookup);
+  DRsimPropertyTable::Benchmark(FindSurface("FilterSurf")->GetMaterialPropertiesTable()->GetProperty("TRANSMITTANCE"),"FilterSurf TRANSMITTANCE",nPoint,nLookup);
+
+  for (auto matName : {"PMMA","Polystyrene","Glass"}) {
+    DRsimPropertyTable::Benchmark(FindMaterial(matName)->GetMaterialPropertiesTable()->GetProperty("ABSLENGTH"),G4String(matName)+" ABSLENGTH",nPoint,nLookup);
+  }
+}
@@ -7,46 +7,115 @@
 #include "G4RunManager.hh"
 #include "G4SDManager.hh"
 #include "G4AutoLock.hh"
-#include "G4Threading.hh"
 
-namespace {
-  G4Mutex DRsimEventActionMutex = G4MUTEX_INITIALIZER;
-  G4Condition DRsimEventActionCV = G4CONDITION_INITIALIZER;
+#include <algorithm>
+
+namespace { G4Mutex DRsimEventActionMutex = G4MUTEX_INITIALIZER; }
+G4bool DRsimEventAction::sPhotonStats = false;
+DRsimPhotonCounts DRsimEventAction::sRunPhotonCounts = DRsimPhotonCounts();
+
+void DRsimPhotonCounts::Add(const DRsimPhotonCounts& other) {
+  tracked += other.tracked;
+  killedPrescale += other.killedPrescale;
+  killedBackward += other.killedBackward;
+  steps += other.steps;
+  time += other.time;
+}
+
+void DRsimPhotonCounts::Print(const G4String& title) const {
+  G4cout << title << " : photons tracked " << tracked << ", killed (prescale " << killedPrescale
+         << ", backward " << killedBackward << "), "
+         << steps << " steps in " << time << " s";
+  if ( time > 0. ) G4cout << " (" << steps/time << " steps/s)";
+  G4cout << G4endl;
+}
+
+void DRsimEventAction::PrintRunPhotonCounts() {
+  G4AutoLock lock(&DRsimEventActionMutex);
+
+  if ( sPhotonStats ) sRunPhotonCounts.Print("DRsim run");
+  sRunPhotonCounts = DRsimPhotonCounts();
 }
 
 DRsimEventAction::DRsimEventAction()
-: G4UserEventAction()
+: G4UserEventAction(), fEventData(0), fTowerHWM(0), fEdepHWM(0), fLeakHWM(0), fPtcHWM(0), fPhotonCounts()
 {
   // set printing per each event
   G4RunManager::GetRunManager()->SetPrintProgress(1);
 }
 
-DRsimEventAction::~DRsimEventAction() {}
+DRsimEventAction::~DRsimEventAction() {
+  delete fEventData;
+}
 
 void DRsimEventAction::BeginOfEventAction(const G4Event*) {
+  // the module count can change when the geometry is rebuilt between runs
+  if ((int)fSiPMCollID.size() != DRsimDetectorConstruction::fNofModules) {
+    G4SDManager* sdManager = G4SDManager::GetSDMpointer();
+    fSiPMCollID.clear();
+    for (int i = 0; i < DRsimDetectorConstruction::fNofModules; i++) {
+      fSiPMCollID.push_back(sdManager->GetCollectionID("ModuleC"+std::to_string(i)));
+    }
+    fSiPMHWM.assign(DRsimDetectorConstruction::fNofModules,0);
+    fEdeps.resize(DRsimDetectorConstruction::fNofModules);
+  }
+
+  if (!fEventData) fEventData = new DRsimInterface::DRsimEventData();
+
 	clear();
 
-  G4SDManager* sdManager = G4SDManager::GetSDMpointer();
-  for (int i = 0; i < DRsimDetectorConstruction::fNofModules; i++) {
-    fSiPMCollID.push_back(sdManager->GetCollectionID("ModuleC"+std::to_string(i)));
+  fPhotonCounts = DRsimPhotonCounts();
+  if ( sPhotonStats ) fTimer.Start();
+}
+
+void DRsimEventAction::clear() {
+  fTowerIdx.assign(DRsimDetectorConstruction::fNofModules,-1);
+  for (auto& edep : fEdeps) {
+    edep.ModuleNum = -1;
+    edep.Edep = 0.;
+    edep.EdepEle = 0.;
+    edep.EdepGamma = 0.;
+    edep.EdepCharged = 0.;
   }
 
-  fEventData = new DRsimInterface::DRsimEventData();
+  fEventData->towers.clear();
+  fEventData->Edeps.clear();
+  fEventData->leaks.clear();
+  fEventData->GenPtcs.clear();
+
+  fEventData->towers.reserve(fTowerHWM);
+  fEventData->Edeps.reserve(fEdepHWM);
+  fEventData->leaks.reserve(fLeakHWM);
+  fEventData->GenPtcs.reserve(fPtcHWM);
 }
 
-void DRsimEventAction::clear() {
-  fSiPMCollID.clear();
-  fTowerMap.clear();
-  fEdepMap.clear();
+void DRsimEventAction::updateHighWater() {
+  fTowerHWM = std::max(fTowerHWM,fEventData->towers.size());
+  fEdepHWM = std::max(fEdepHWM,fEventData->Edeps.size());
+  fLeakHWM = std::max(fLeakHWM,fEventData->leaks.size());
+  fPtcHWM = std::max(fPtcHWM,fEventData->GenPtcs.size());
+
+  for (const auto& tower : fEventData->towers) {
+    fSiPMHWM.at(tower.ModuleNum) = std::max(fSiPMHWM.at(tower.ModuleNum),tower.SiPMs.size());
+  }
 }
 
 void DRsimEventAction::EndOfEventAction(const G4Event* event) {
+  // e.g. the HepMC input ran out, the event has no number
+  if (DRsimPrimaryGeneratorAction::sIdxEvt < 0) return;
+
+  if (event->IsAborted()) {
+    skipEvent();
+    return;
+  }
+
   G4HCofThisEvent* hce = event->GetHCofThisEvent();
   if (!hce) {
     G4ExceptionDescription msg;
     msg << "No hits collection of this event found." << G4endl;
     G4Exception("DRsimEventAction::EndOfEventAction()",
     "DRsimCode001", JustWarning, msg);
+    skipEvent();
     return;
   }
 
@@ -67,12 +136,8 @@ void DRsimEventAction::EndOfEventAction(const G4Event* event) {
     }
   }
 
-  for (const auto& towerMap : fTowerMap) {
-    fEventData->towers.push_back(towerMap.second);
-  }
-
-  for (const auto& edepMap : fEdepMap) {
-    fEventData->Edeps.push_back(edepMap.second);
+  for (const auto& edep : fEdeps) {
+    if (edep.ModuleNum >= 0) fEventData->Edeps.push_back(edep);
   }
 
   for (int iVtx = 0; iVtx < event->GetNumberOfPrimaryVertex(); iVtx++) {
@@ -86,36 +151,60 @@ void DRsimEventAction::EndOfEventAction(const G4Event* event) {
 
   fEventData->event_number = DRsimPrimaryGeneratorAction::sIdxEvt;
 
-  queue();
+  updateHighWater();
 
-  delete fEventData;
+  if ( sPhotonStats ) {
+    fTimer.Stop();
+    fPhotonCounts.time = fTimer.GetRealElapsed();
+    fPhotonCounts.Print("DRsim event "+std::to_string(event->GetEventID()));
+
+    G4AutoLock lock(&DRsimEventActionMutex);
+    sRunPhotonCounts.Add(fPhotonCounts);
+  }
+
+  if (DRsimRunAction::sThreadRootIO) {
+    // the swap leaves the previous event's buffers behind for reuse
+    DRsimRunAction::sThreadRootIO->fill(std::move(*fEventData));
+  } else {
+    // the writer thread owns the event from here on and hands back a written one if it has any;
+    // sub-events of one HepMC event are merged there
+    fEventData = DRsimRunAction::sWriter->push(fEventData,DRsimPrimaryGeneratorAction::sSubEvt,DRsimPrimaryGeneratorAction::sNumSubEvt);
+  }
+}
+
+void DRsimEventAction::skipEvent() {
+  // the ordered writer would otherwise wait for this event_number forever
+  if (!DRsimRunAction::sThreadRootIO) DRsimRunAction::sWriter->skip(DRsimPrimaryGeneratorAction::sIdxEvt,DRsimPrimaryGeneratorAction::sSubEvt,DRsimPrimaryGeneratorAction::sNumSubEvt);
 }
 
 void DRsimEventAction::fillHits(DRsimSiPMHit* hit) {
-  DRsimInterface::DRsimSiPMData sipmData;
-  sipmData.count = hit->GetPhotonCount();
-  sipmData.SiPMnum = hit->GetSiPMnum();
-  sipmData.x = hit->GetSiPMXY().first;
-  sipmData.y = hit->GetSiPMXY().second;
-  sipmData.pos = std::make_tuple(hit->GetSiPMpos().x(),hit->GetSiPMpos().y(),hit->GetSiPMpos().z());
-  sipmData.timeStruct = hit->GetTimeStruct();
-  sipmData.wavlenSpectrum = hit->GetWavlenSpectrum();
+  int& towerIdx = fTowerIdx.at(hit->GetModuleNum());
 
-  auto towerIter = fTowerMap.find(hit->GetModuleNum());
+  if ( towerIdx < 0 ) {
+    // towers are built in place; fTowerIdx only remembers where each module went
+    towerIdx = fEventData->towers.size();
+    fEventData->towers.emplace_back();
 
-  if ( towerIter==fTowerMap.end() ) {
-    DRsimInterface::DRsimTowerData towerData;
+    DRsimInterface::DRsimTowerData& towerData = fEventData->towers.back();
     towerData.ModuleNum = hit->GetModuleNum();
     towerData.numx = hit->GetTowerXY().first;
     towerData.numy = hit->GetTowerXY().second;
+    towerData.SiPMs.reserve(fSiPMHWM.at(towerData.ModuleNum));
     // towerData.innerR = hit->GetTowerInnerR();
     // towerData.towerH = hit->GetTowerH();
-    towerData.SiPMs.push_back(sipmData);
-
-    fTowerMap.insert(std::make_pair(hit->GetModuleNum(),towerData));
-  } else {
-    towerIter->second.SiPMs.push_back(sipmData);
   }
+
+  std::vector<DRsimInterface::DRsimSiPMData>& SiPMs = fEventData->towers.at(towerIdx).SiPMs;
+  SiPMs.emplace_back();
+
+  DRsimInterface::DRsimSiPMData& sipmData = SiPMs.back();
+  sipmData.count = hit->GetPhotonCount();
+  sipmData.SiPMnum = hit->GetSiPMnum();
+  sipmData.x = hit->GetSiPMXY().first;
+  sipmData.y = hit->GetSiPMXY().second;
+  sipmData.pos = std::make_tuple(hit->GetSiPMpos().x(),hit->GetSiPMpos().y(),hit->GetSiPMpos().z());
+  sipmData.timeStruct = hit->GetTimeStruct();
+  sipmData.wavlenSpectrum = hit->GetWavlenSpectrum();
 }
 
 void DRsimEventAction::fillPtcs(G4PrimaryVertex* vtx, G4PrimaryParticle* ptc) {
@@ -133,31 +222,24 @@ void DRsimEventAction::fillPtcs(G4PrimaryVertex* vtx, G4PrimaryParticle* ptc) {
   fEventData->GenPtcs.push_back(GenData);
 }
 
-void DRsimEventAction::fillEdeps(DRsimInterface::DRsimEdepData edepData) {
-  auto towerIter = fEdepMap.find(edepData.ModuleNum);
-
-  if ( towerIter==fEdepMap.end() ) {
-    fEdepMap.insert(std::make_pair(edepData.ModuleNum,edepData));
-  } else {
-    towerIter->second.Edep += edepData.Edep;
-    towerIter->second.EdepEle += edepData.EdepEle;
-    towerIter->second.EdepGamma += edepData.EdepGamma;
-    towerIter->second.EdepCharged += edepData.EdepCharged;
+void DRsimEventAction::fillEdeps(const DRsimInterface::DRsimEdepData& edepData) {
+  // the stepping action only passes modules of the geometry; anything else would write past fEdeps
+  if ( edepData.ModuleNum < 0 || edepData.ModuleNum >= (G4int)fEdeps.size() ) {
+    G4ExceptionDescription msg;
+    msg << "Energy deposit in module " << edepData.ModuleNum << ", the geometry has " << fEdeps.size() << G4endl;
+    G4Exception("DRsimEventAction::fillEdeps()", "DRsimCode014", EventMustBeAborted, msg);
+    return;
   }
+
+  DRsimInterface::DRsimEdepData& edep = fEdeps[edepData.ModuleNum];
+
+  edep.ModuleNum = edepData.ModuleNum;
+  edep.Edep += edepData.Edep;
+  edep.EdepEle += edepData.EdepEle;
+  edep.EdepGamma += edepData.EdepGamma;
+  edep.EdepCharged += edepData.EdepCharged;
 }
 
 void DRsimEventAction::fillLeaks(DRsimInterface::DRsimLeakageData leakData) {
   fEventData->leaks.push_back(leakData);
 }
-
-void DRsimEventAction::queue() {
-  while ( DRsimRunAction::sNumEvt != DRsimPrimaryGeneratorAction::sIdxEvt ) {
-    G4AutoLock lock(&DRsimEventActionMutex);
-    if ( DRsimRunAction::sNumEvt == DRsimPrimaryGeneratorAction::sIdxEvt ) break;
-    G4CONDITIONWAIT(&DRsimEventActionCV, &lock);
-  }
-  G4AutoLock lock(&DRsimEventActionMutex);
-  DRsimRunAction::sRootIO->fill(fEventData);
-  DRsimRunAction::sNumEvt++;
-  G4CONDITIONBROADCAST(&DRsimEventActionCV);
-}
@@ -0,0 +1,183 @@
+#include "DRsimEventWriter.hh"
+
+#include <algorithm>
+#include <unordered_map>
+
+DRsimEventWriter::DRsimEventWriter(DRsimRootInterface* rootIO, G4int firstIdx, G4int maxPending)
+: fRootIO(rootIO), fNextIdx(firstIdx), fMaxPending(maxPending), fFinish(false)
+{
+  fThread = std::thread(&DRsimEventWriter::run,this);
+}
+
+DRsimEventWriter::~DRsimEventWriter() {
+  finish();
+}
+
+DRsimInterface::DRsimEventData* DRsimEventWriter::push(DRsimInterface::DRsimEventData* evt, G4int subEvt, G4int nSubEvt) {
+  // would sort first and never come up, blocking everything behind it
+  if (evt->event_number < 0) {
+    G4ExceptionDescription msg;
+    msg << "event without event_number (" << evt->event_number << ") not written" << G4endl;
+    G4Exception("DRsimEventWriter::push()", "DRsimCode003", JustWarning, msg);
+    return evt;
+  }
+
+  G4AutoLock lock(&fMutex);
+
+  if (!admit(lock,evt->event_number,evt,subEvt,nSubEvt)) return evt;
+
+  if (fFree.empty()) return 0;
+
+  DRsimInterface::DRsimEventData* recycled = fFree.back();
+  fFree.pop_back();
+
+  return recycled;
+}
+
+void DRsimEventWriter::skip(G4int event_number, G4int subEvt, G4int nSubEvt) {
+  if (event_number < 0) return;
+
+  G4AutoLock lock(&fMutex);
+  admit(lock,event_number,0,subEvt,nSubEvt);
+}
+
+G4bool DRsimEventWriter::admit(G4AutoLock& lock, G4int idx, DRsimInterface::DRsimEventData* evt, G4int subEvt, G4int nSubEvt) {
+  if (idx < fNextIdx) {
+    G4ExceptionDescription msg;
+    msg << "event " << idx << " arrived after the writer moved on to " << fNextIdx << ", not written" << G4endl;
+    G4Exception("DRsimEventWriter::admit()", "DRsimCode003", JustWarning, msg);
+    return false;
+  }
+
+  // the event the writer waits for is always admitted, otherwise a full buffer could never drain;
+  // so are the other parts of an event already buffered
+  fWorkerCV.wait(lock, [this,idx] {
+    return (G4int)fPending.size() < fMaxPending || idx == fNextIdx || fPending.count(idx);
+  });
+
+  Pending& pending = fPending[idx];
+  if (pending.parts.empty()) pending.parts.assign(nSubEvt,0);
+  pending.parts.at(subEvt) = evt;
+  pending.nArrived++;
+
+  if (ready()) fWriterCV.notify_one();
+
+  return true;
+}
+
+void DRsimEventWriter::finish() {
+  {
+    G4AutoLock lock(&fMutex);
+    fFinish = true;
+  }
+  fWriterCV.notify_one();
+
+  if (fThread.joinable()) fThread.join();
+
+  for (auto evt : fFree) delete evt;
+  fFree.clear();
+}
+
+void DRsimEventWriter::run() {
+  G4AutoLock lock(&fMutex);
+
+  while (true) {
+    fWriterCV.wait(lock, [this] { return fFinish || ready(); });
+
+    // finishing with the next event missing or incomplete, e.g. a worker stopped by AbortRun
+    // before the events it had been handed; write what came after it
+    if (!ready()) {
+      if (fPending.empty()) break;
+
+      G4ExceptionDescription msg;
+      auto head = fPending.begin();
+      if (head->first != fNextIdx) {
+        msg << "events " << fNextIdx << " to " << head->first-1 << " never arrived" << G4endl;
+        fNextIdx = head->first;
+      } else {
+        msg << "event " << fNextIdx << " has " << head->second.nArrived << " of " << head->second.parts.size() << " parts, not written" << G4endl;
+        for (auto part : head->second.parts) delete part;
+        fPending.erase(head);
+        fNextIdx++;
+      }
+      G4Exception("DRsimEventWriter::run()", "DRsimCode003", JustWarning, msg);
+
+      continue;
+    }
+
+    std::vector<DRsimInterface::DRsimEventData*> parts = std::move(fPending.begin()->second.parts);
+    fPending.erase(fPending.begin());
+
+    // an event with a skipped part is dropped whole, a split event without it would be biased
+    G4int nSkipped = std::count(parts.begin(),parts.end(),(DRsimInterface::DRsimEventData*)0);
+    if (nSkipped > 0 && nSkipped < (G4int)parts.size()) {
+      G4ExceptionDescription msg;
+      msg << nSkipped << " of " << parts.size() << " sub-events of event " << fNextIdx << " aborted, not written" << G4endl;
+      G4Exception("DRsimEventWriter::run()", "DRsimCode003", JustWarning, msg);
+    }
+
+    // merge (in part order, so the output does not depend on which worker finished first)
+    // and serialize without holding the lock so workers can keep handing over events
+    if (nSkipped==0) {
+      lock.unlock();
+      for (unsigned i = 1; i < parts.size(); i++) merge(*parts.front(),*parts.at(i));
+      fRootIO->fill(std::move(*parts.front()));
+      lock.lock();
+    }
+
+    for (auto evt : parts) {
+      if (!evt) continue;
+      if ((G4int)fFree.size() < fMaxPending) fFree.push_back(evt);
+      else delete evt;
+    }
+
+    fNextIdx++;
+    fWorkerCV.notify_all();
+  }
+}
+
+void DRsimEventWriter::merge(DRsimInterface::DRsimEventData& into, const DRsimInterface::DRsimEventData& from) {
+  for (const auto& tower : from.towers) {
+    auto intoTower = std::find_if(into.towers.begin(), into.towers.end(),
+      [&tower] (const DRsimInterface::DRsimTowerData& t) { return t.ModuleNum == tower.ModuleNum; });
+
+    if (intoTower == into.towers.end()) {
+      into.towers.push_back(tower);
+      continue;
+    }
+
+    std::unordered_map<int,size_t> sipmIdx;
+    for (size_t i = 0; i < intoTower->SiPMs.size(); i++) sipmIdx[intoTower->SiPMs[i].SiPMnum] = i;
+
+    for (const auto& sipm : tower.SiPMs) {
+      auto found = sipmIdx.find(sipm.SiPMnum);
+      if (found == sipmIdx.end()) {
+        intoTower->SiPMs.push_back(sipm);
+        continue;
+      }
+
+      DRsimInterface::DRsimSiPMData& intoSiPM = intoTower->SiPMs[found->second];
+      intoSiPM.count += sipm.count;
+      for (const auto& bin : sipm.timeStruct) intoSiPM.timeStruct[bin.first] += bin.second;
+      for (const auto& bin : sipm.wavlenSpectrum) intoSiPM.wavlenSpectrum[bin.first] += bin.second;
+    }
+  }
+
+  for (const auto& edep : from.Edeps) {
+    auto intoEdep = std::find_if(into.Edeps.begin(), into.Edeps.end(),
+      [&edep] (const DRsimInterface::DRsimEdepData& e) { return e.ModuleNum == edep.ModuleNum; });
+
+    if (intoEdep == into.Edeps.end()) {
+      into.Edeps.push_back(edep);
+      continue;
+    }
+
+    intoEdep->Edep += edep.Edep;
+    intoEdep->EdepEle += edep.EdepEle;
+    intoEdep->EdepGamma += edep.EdepGamma;
+    intoEdep->EdepCharged += edep.EdepCharged;
+  }
+
+  into.leaks.insert(into.leaks.end(), from.leaks.begin(), from.leaks.end());
+  into.GenPtcs.insert(into.GenPtcs.end(), from.GenPtcs.begin(), from.GenPtcs.end());
+}
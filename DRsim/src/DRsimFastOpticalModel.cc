@@ -0,0 +1,103 @@
+#include "DRsimFastOpticalModel.hh"
+#include "DRsimMaterials.hh"
+#include "DRsimStackingAction.hh"
+#include "RecoInterface.h"
+
+#include "G4OpticalPhoton.hh"
+#include "G4SDManager.hh"
+#include "G4NavigationHistory.hh"
+#include "G4SystemOfUnits.hh"
+#include "Randomize.hh"
+
+#include <cmath>
+
+DRsimFastOpticalModel::DRsimFastOpticalModel(G4String name, G4Region* envelope, G4int nofFiber, G4double fiberHalfZ, G4double SiPMz, G4bool doReflector, G4int nPropertyPoints)
+: G4VFastSimulationModel(name,envelope), fNofFiber(nofFiber), fFiberHalfZ(fiberHalfZ), fSiPMz(SiPMz), fGroupVelocity(158.8*mm/ns), fPropertyPoints(nPropertyPoints)
+{
+  DRsimMaterials* materials = DRsimMaterials::GetInstance();
+
+  fFilterTransmittance = DRsimPropertyTable(materials->GetOpticalSurface("FilterSurf")->GetMaterialPropertiesTable()->GetProperty("TRANSMITTANCE"),fPropertyPoints);
+  fSiPMEfficiency = DRsimPropertyTable(materials->GetOpticalSurface("SiPMSurf")->GetMaterialPropertiesTable()->GetProperty("EFFICIENCY"),fPropertyPoints);
+
+  // flat table, any photon energy will do
+  fMirrorReflectivity = doReflector ? materials->GetOpticalSurface("MirrorSurf")->GetMaterialPropertiesTable()->GetProperty("REFLECTIVITY")->Value(2.*eV) : 0.;
+}
+
+G4bool DRsimFastOpticalModel::IsApplicable(const G4ParticleDefinition& particle) {
+  return &particle == G4OpticalPhoton::OpticalPhotonDefinition();
+}
+
+DRsimSiPMSD* DRsimFastOpticalModel::GetSD(G4int moduleNum) {
+  if ( moduleNum >= (G4int)fSD.size() ) fSD.resize(moduleNum+1,0);
+
+  if (!fSD[moduleNum]) fSD[moduleNum] = dynamic_cast<DRsimSiPMSD*>(G4SDManager::GetSDMpointer()->FindSensitiveDetector("Module"+std::to_string(moduleNum),false));
+
+  return fSD[moduleNum];
+}
+
+const DRsimFastOpticalModel::MaterialTables& DRsimFastOpticalModel::GetTables(const G4Material* material) {
+  // sized to the whole material table at once, references handed out stay valid
+  if ( fMaterialTables.size() < G4Material::GetNumberOfMaterials() ) fMaterialTables.resize(G4Material::GetNumberOfMaterials());
+
+  MaterialTables& tables = fMaterialTables[material->GetIndex()];
+  if ( !tables.filled ) {
+    tables.filled = true;
+
+    G4MaterialPropertiesTable* mpt = material->GetMaterialPropertiesTable();
+    G4MaterialPropertyVector* rindex = mpt ? mpt->GetProperty("RINDEX") : 0;
+    G4MaterialPropertyVector* absLength = mpt ? mpt->GetProperty("ABSLENGTH") : 0;
+    if ( rindex ) tables.rindex = DRsimPropertyTable(rindex,fPropertyPoints);
+    if ( absLength ) tables.absLength = DRsimPropertyTable(absLength,fPropertyPoints);
+  }
+
+  return tables;
+}
+
+void DRsimFastOpticalModel::DoIt(const G4FastTrack& fastTrack, G4FastStep& fastStep) {
+  fastStep.KillPrimaryTrack();
+  fastStep.ProposePrimaryTrackPathLength(0.);
+  fastStep.ProposeTotalEnergyDeposited(0.);
+
+  const G4Track* track = fastTrack.GetPrimaryTrack();
+  const G4VTouchable* touchable = track->GetTouchable();
+  const G4double energy = track->GetTotalEnergy();
+
+  // core and clad share the fiber frame, whose z axis is the module axis
+  const G4ThreeVector pos = fastTrack.GetPrimaryTrackLocalPosition();
+  const G4ThreeVector dir = fastTrack.GetPrimaryTrackLocalDirection();
+
+  const MaterialTables& core = GetTables(track->GetMaterial());
+  const MaterialTables& clad = GetTables(touchable->GetVolume(1)->GetLogicalVolume()->GetMaterial());
+  if ( !core.rindex.GetVector() || !core.absLength.GetVector() || !clad.rindex.GetVector() ) return;
+
+  const G4double cosCritical = clad.rindex.Value(energy) / core.rindex.Value(energy);
+
+  G4double axial;
+  if ( dir.z() >= cosCritical ) {
+    axial = fFiberHalfZ - pos.z();
+  } else if ( dir.z() <= -cosCritical && fMirrorReflectivity > 0. ) {
+    if ( G4UniformRand() > fMirrorReflectivity ) return;
+    axial = pos.z() + 3.*fFiberHalfZ;
+  } else {
+    return;
+  }
+
+  const G4double pathLength = axial / std::abs(dir.z());
+  if ( G4UniformRand() > std::exp( -pathLength / core.absLength.Value(energy) ) ) return;
+
+  const G4int SiPMnum = touchable->GetVolume(1)->GetCopyNo();
+  const G4int moduleNum = touchable->GetVolume(2)->GetCopyNo();
+
+  // S channels sit behind the filter, see DRsimFilterParameterisation
+  if ( !RecoInterface::IsCerenkov(SiPMnum/fNofFiber,SiPMnum%fNofFiber) && G4UniformRand() > fFilterTransmittance.Value(energy) ) return;
+  if ( G4UniformRand() > fSiPMEfficiency.Value(energy) ) return;
+
+  DRsimSiPMSD* sd = GetSD(moduleNum);
+  if (!sd) return;
+
+  const G4NavigationHistory* history = touchable->GetHistory();
+  const G4ThreeVector fiberXY = touchable->GetVolume(1)->GetTranslation();
+  const G4ThreeVector SiPMpos = history->GetTransform(history->GetDepth()-2).Inverse().TransformPoint(G4ThreeVector(fiberXY.x(),fiberXY.y(),fSiPMz));
+
+  sd->AddFastHit(SiPMnum,energy,track->GetGlobalTime()+axial/fGroupVelocity,SiPMpos,DRsimStackingAction::sPhotonPrescale);
+}
@@ -0,0 +1,57 @@
+#include "DRsimFiberSD.hh"
+#include "RecoInterface.h"
+
+#include "G4SDManager.hh"
+#include "G4NavigationHistory.hh"
+#include "G4Poisson.hh"
+#include "G4SystemOfUnits.hh"
+
+DRsimFiberSD::DRsimFiberSD(const G4String& name, G4int nofFiber, G4double fiberHalfZ, G4double SiPMz)
+: G4VSensitiveDetector(name), fLUT(0), fNofFiber(nofFiber), fFiberHalfZ(fiberHalfZ), fSiPMz(SiPMz)
+{}
+
+DRsimSiPMSD* DRsimFiberSD::GetSD(G4int moduleNum) {
+  if ( moduleNum >= (G4int)fSD.size() ) fSD.resize(moduleNum+1,0);
+
+  if (!fSD[moduleNum]) fSD[moduleNum] = dynamic_cast<DRsimSiPMSD*>(G4SDManager::GetSDMpointer()->FindSensitiveDetector("Module"+std::to_string(moduleNum),false));
+
+  return fSD[moduleNum];
+}
+
+G4bool DRsimFiberSD::ProcessHits(G4Step* step, G4TouchableHistory*) {
+  G4double edep = step->GetTotalEnergyDeposit();
+  if ( edep <= 0. || step->GetTrack()->GetDefinition()->GetPDGCharge() == 0. ) return false;
+
+  // core(0) -> clad(1, SiPM number) -> module(2, module number), the fiber frame is the clad frame
+  const G4StepPoint* preStep = step->GetPreStepPoint();
+  const G4VTouchable* touchable = preStep->GetTouchable();
+  const G4int SiPMnum = touchable->GetVolume(1)->GetCopyNo();
+  const G4int type = RecoInterface::IsCerenkov(SiPMnum/fNofFiber,SiPMnum%fNofFiber) ? 1 : 0;
+
+  const G4ThreeVector midPoint = 0.5*( preStep->GetPosition() + step->GetPostStepPoint()->GetPosition() );
+  const G4double distance = fFiberHalfZ - touchable->GetHistory()->GetTopTransform().TransformPoint(midPoint).z();
+
+  if ( DRsimPhotonLUT::IsCalibrating() ) {
+    DRsimPhotonLUTBuilder::GetThreadBuilder()->FillEdep(type,distance,edep);
+    return true;
+  }
+
+  if (!fLUT) fLUT = DRsimPhotonLUT::GetShared();
+  const G4int depthBin = fLUT->DepthBin(distance);
+  const G4long npe = G4Poisson( fLUT->Yield(type,depthBin)*edep/MeV );
+  if ( npe==0 ) return true;
+
+  DRsimSiPMSD* sd = GetSD(touchable->GetVolume(2)->GetCopyNo());
+  if (!sd) return false;
+
+  const G4NavigationHistory* history = touchable->GetHistory();
+  const G4ThreeVector fiberXY = touchable->GetVolume(1)->GetTranslation();
+  const G4ThreeVector SiPMpos = history->GetTransform(history->GetDepth()-2).Inverse().TransformPoint(G4ThreeVector(fiberXY.x(),fiberXY.y(),fSiPMz));
+  const G4double time = 0.5*( preStep->GetGlobalTime() + step->GetPostStepPoint()->GetGlobalTime() );
+
+  for (G4long ipe = 0; ipe < npe; ipe++) {
+    sd->AddFastHit(SiPMnum,fLUT->SampleEnergy(type,depthBin),time+fLUT->SampleDelay(type,depthBin),SiPMpos,1);
+  }
+
+  return true;
+}
@@ -0,0 +1,149 @@
+#include "DRsimGeometryCache.hh"
+
+#include "G4LogicalVolumeStore.hh"
+#include "G4PhysicalVolumeStore.hh"
+#include "G4SolidStore.hh"
+#include "G4LogicalSkinSurface.hh"
+#include "G4LogicalBorderSurface.hh"
+#include "G4Material.hh"
+
+#ifdef G4LIB_USE_GDML
+#include "G4GDMLParser.hh"
+#endif
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+#ifdef G4LIB_USE_GDML
+namespace {
+  // drops a partially loaded geometry, as Construct() does before building
+  void clearStores() {
+    G4LogicalSkinSurface::CleanSurfaceTable();
+    G4LogicalBorderSurface::CleanSurfaceTable();
+    G4PhysicalVolumeStore::GetInstance()->Clean();
+    G4LogicalVolumeStore::GetInstance()->Clean();
+    G4SolidStore::GetInstance()->Clean();
+  }
+}
+#endif
+
+DRsimGeometryCache::DRsimGeometryCache(const G4String& basename)
+: fGDMLName(basename+".gdml"), fBindingName(basename+".bindings")
+{}
+
+G4bool DRsimGeometryCache::Exists() const {
+#ifdef G4LIB_USE_GDML
+  // the side-car is renamed into place first, the GDML file last
+  return std::ifstream(fGDMLName).good() && std::ifstream(fBindingName).good();
+#else
+  return false;
+#endif
+}
+
+G4VPhysicalVolume* DRsimGeometryCache::Load(DRsimMaterials* materials) {
+#ifdef G4LIB_USE_GDML
+  G4GDMLParser parser;
+  parser.Read(fGDMLName,false);
+  G4VPhysicalVolume* world = parser.GetWorldVolume();
+
+  if (!world) {
+    clearStores();
+    return 0;
+  }
+
+  // GDML creates material copies without the optical tables, point back to the originals
+  for (auto lv : *G4LogicalVolumeStore::GetInstance()) {
+    G4Material* mat = G4Material::GetMaterial(lv->GetMaterial()->GetName(),false);
+    if (mat) lv->SetMaterial(mat);
+  }
+
+  // surfaces read from GDML are replaced by the ones from the side-car
+  G4LogicalSkinSurface::CleanSurfaceTable();
+  G4LogicalBorderSurface::CleanSurfaceTable();
+
+  if (!ReadBindings(materials)) {
+    clearStores();
+    return 0;
+  }
+
+  return world;
+#else
+  (void)materials;
+  return 0;
+#endif
+}
+
+G4bool DRsimGeometryCache::ReadBindings(DRsimMaterials* materials) {
+  std::ifstream in(fBindingName);
+  std::string line;
+
+  fModuleProp.clear();
+  fCathodeNames.clear();
+
+  while ( std::getline(in,line) ) {
+    std::istringstream tokens(line);
+    std::string tag;
+    if ( !(tokens >> tag) || tag[0]=='#' ) continue;
+
+    if ( tag=="module" ) {
+      DRsimInterface::DRsimModuleProperty prop;
+      std::string cathName;
+      tokens >> prop.ModuleNum >> prop.towerXY.first >> prop.towerXY.second >> cathName;
+      fModuleProp.push_back(prop);
+      fCathodeNames.push_back(cathName);
+    } else if ( tag=="skin" ) {
+      std::string name, lvName, surfName;
+      tokens >> name >> lvName >> surfName;
+      G4LogicalVolume* lv = G4LogicalVolumeStore::GetInstance()->GetVolume(lvName,false);
+      if (!lv) return false;
+      new G4LogicalSkinSurface(name,lv,materials->GetOpticalSurface(surfName));
+    } else if ( tag=="border" ) {
+      std::string name, pv1Name, pv2Name, surfName;
+      tokens >> name >> pv1Name >> pv2Name >> surfName;
+      G4VPhysicalVolume* pv1 = G4PhysicalVolumeStore::GetInstance()->GetVolume(pv1Name,false);
+      G4VPhysicalVolume* pv2 = G4PhysicalVolumeStore::GetInstance()->GetVolume(pv2Name,false);
+      if (!pv1 || !pv2) return false;
+      new G4LogicalBorderSurface(name,pv1,pv2,materials->GetOpticalSurface(surfName));
+    }
+  }
+
+  return true;
+}
+
+void DRsimGeometryCache::Save(G4VPhysicalVolume* world, const std::vector<DRsimInterface::DRsimModuleProperty>& moduleProp, const std::vector<G4LogicalVolume*>& cathode) const {
+#ifdef G4LIB_USE_GDML
+  // concurrent jobs may race on a shared cache, write to private names and rename into place
+  G4String tmpBase = fGDMLName.substr(0,fGDMLName.size()-5)+".tmp"+std::to_string(getpid());
+
+  std::ofstream out(tmpBase+".bindings");
+  out << "# DRsim geometry bindings, see DRsimGeometryCache" << std::endl;
+
+  for (unsigned int i = 0; i < moduleProp.size(); i++) {
+    out << "module " << moduleProp.at(i).ModuleNum << " " << moduleProp.at(i).towerXY.first << " " << moduleProp.at(i).towerXY.second
+        << " " << ( i < cathode.size() && cathode.at(i) ? cathode.at(i)->GetName() : G4String("none") ) << std::endl;
+  }
+
+  const G4LogicalSkinSurfaceTable* skinTable = G4LogicalSkinSurface::GetSurfaceTable();
+  for (auto skin : *skinTable) {
+    out << "skin " << skin->GetName() << " " << skin->GetLogicalVolume()->GetName() << " " << skin->GetSurfaceProperty()->GetName() << std::endl;
+  }
+
+  const G4LogicalBorderSurfaceTable* borderTable = G4LogicalBorderSurface::GetSurfaceTable();
+  for (auto border : *borderTable) {
+    out << "border " << border->GetName() << " " << border->GetVolume1()->GetName() << " " << border->GetVolume2()->GetName()
+        << " " << border->GetSurfaceProperty()->GetName() << std::endl;
+  }
+  out.close();
+
+  G4GDMLParser parser;
+  parser.Write(tmpBase+".gdml",world);
+
+  std::rename((tmpBase+".bindings").c_str(),fBindingName.c_str());
+  std::rename((tmpBase+".gdml").c_str(),fGDMLName.c_str());
+#else
+  (void)world; (void)moduleProp; (void)cathode;
+  G4Exception("DRsimGeometryCache::Save()", "DRsimCode006", JustWarning, "Geant4 was built without GDML, the geometry cache is disabled");
+#endif
+}
@@ -0,0 +1,67 @@
+#include "DRsimGeometryDescriptor.hh"
+
+#include "G4ios.hh"
+
+#include <fstream>
+#include <sstream>
+
+DRsimGeometryDescriptor::DRsimGeometryDescriptor()
+: nofRow(7), nofPlate(60), nofFiber(60), fiberPitch(1.5*mm),
+moduleH(90.*mm), moduleW(90.*mm), towerDepth(2500.*mm), frontL(1500.*mm)
+{}
+
+G4bool DRsimGeometryDescriptor::Load(const G4String& filename) {
+  std::ifstream in(filename);
+
+  if (!in.good()) {
+    G4Exception("DRsimGeometryDescriptor::Load()", "DRsimCode005", JustWarning, ("cannot open "+filename).c_str());
+    return false;
+  }
+
+  // lengths are in mm, '#' starts a comment
+  std::string line;
+  while ( std::getline(in,line) ) {
+    line = line.substr(0,line.find('#'));
+
+    std::istringstream tokens(line);
+    std::string key;
+    G4double value;
+    if ( !(tokens >> key >> value) ) continue;
+
+    if ( key=="nofRow" ) nofRow = (G4int)value;
+    else if ( key=="nofPlate" ) nofPlate = (G4int)value;
+    else if ( key=="nofFiber" ) nofFiber = (G4int)value;
+    else if ( key=="fiberPitch" ) fiberPitch = value*mm;
+    else if ( key=="moduleH" ) moduleH = value*mm;
+    else if ( key=="moduleW" ) moduleW = value*mm;
+    else if ( key=="towerDepth" ) towerDepth = value*mm;
+    else if ( key=="frontL" ) frontL = value*mm;
+    else {
+      G4Exception("DRsimGeometryDescriptor::Load()", "DRsimCode005", JustWarning, ("unknown key "+key+" in "+filename).c_str());
+    }
+  }
+
+  return true;
+}
+
+G4bool DRsimGeometryDescriptor::Validate(G4double fiberRadius, G4double readoutT) const {
+  G4ExceptionDescription msg;
+
+  if ( nofRow < 1 || nofPlate < 1 || nofFiber < 1 ) msg << "grid sizes must be positive" << G4endl;
+  if ( 2.*fiberRadius > fiberPitch ) msg << "fiber pitch " << fiberPitch/mm << " mm is smaller than the fiber diameter" << G4endl;
+  if ( SiPMSize > fiberPitch ) msg << "fiber pitch " << fiberPitch/mm << " mm is smaller than the SiPM cell of " << SiPMSize/mm << " mm" << G4endl;
+  if ( nofPlate*fiberPitch > moduleH || nofFiber*fiberPitch > moduleW ) msg << "fiber lattice does not fit in the module" << G4endl;
+  if ( nofRow*moduleH/2. > worldHalf || nofRow*moduleW/2. > worldHalf ) msg << "tower grid does not fit in the world box" << G4endl;
+  if ( frontL-readoutT < -worldHalf || frontL+towerDepth+readoutT > worldHalf )
+    msg << "towers from " << (frontL-readoutT)/mm << " to " << (frontL+towerDepth+readoutT)/mm << " mm exceed the world box of +-" << worldHalf/mm << " mm" << G4endl;
+
+  if ( msg.str().empty() ) return true;
+
+  G4Exception("DRsimGeometryDescriptor::Validate()", "DRsimCode005", FatalException, msg);
+  return false;
+}
+
+void DRsimGeometryDescriptor::Print() const {
+  G4cout << "DRsim geometry : " << nofRow << "x" << nofRow << " modules of " << moduleH/mm << "x" << moduleW/mm << "x" << towerDepth/mm
+         << " mm, " << nofPlate << "x" << nofFiber << " fibers at " << fiberPitch/mm << " mm pitch, front face at " << frontL/mm << " mm" << G4endl;
+}
@@ -9,21 +9,21 @@
 #include "G4VisAttributes.hh"
 #include "G4Colour.hh"
 
-DRsimMirrorParameterisation::DRsimMirrorParameterisation(const G4int numx, const G4int numy)
+DRsimMirrorParameterisation::DRsimMirrorParameterisation(const DRsimGeometryDescriptor& geom)
 : G4VPVParameterisation()
 {
-  for ( G4int copyNo = 0; copyNo < numx*numy; copyNo++ ) {
+  for ( G4int copyNo = 0; copyNo < geom.nofPlate*geom.nofFiber; copyNo++ ) {
 
-    G4int column = copyNo / numy;
-    G4int row = copyNo % numy;
+    G4int column = copyNo / geom.nofFiber;
+    G4int row = copyNo % geom.nofFiber;
 
     if ( RecoInterface::IsCerenkov(column,row) ) {
-      fXMirror.push_back( -90.*mm/2 + column*1.5*mm + 0.75*mm );
-      fYMirror.push_back( -90.*mm/2 + row*1.5*mm + 0.75*mm );
+      fXMirror.push_back( geom.FiberX(column) );
+      fYMirror.push_back( geom.FiberY(row) );
     }
   }
-  fNumx = numx;
-  fNumy = numy;
+  fNumx = geom.nofPlate;
+  fNumy = geom.nofFiber;
 }
 
 DRsimMirrorParameterisation::~DRsimMirrorParameterisation() {}
@@ -0,0 +1,63 @@
+#include "DRsimNavigationBenchmark.hh"
+
+#include "G4Navigator.hh"
+#include "G4Box.hh"
+#include "G4LogicalVolume.hh"
+#include "G4Timer.hh"
+#include "G4SystemOfUnits.hh"
+#include "Randomize.hh"
+
+DRsimNavigationBenchmark::DRsimNavigationBenchmark(G4VPhysicalVolume* world, G4VPhysicalVolume* module)
+: fWorld(world), fModule(module), fPhysicsStep(1.*mm)
+{}
+
+void DRsimNavigationBenchmark::Run(G4int nRay, G4bool charged) {
+  const G4Box* box = dynamic_cast<const G4Box*>(fModule->GetLogicalVolume()->GetSolid());
+  if (!box) {
+    G4Exception("DRsimNavigationBenchmark::Run()", "DRsimCode004", JustWarning, "module solid is not a box");
+    return;
+  }
+
+  // a private navigator leaves the tracking navigator untouched
+  G4Navigator navigator;
+  navigator.SetWorldVolume(fWorld);
+
+  const G4ThreeVector center = fModule->GetTranslation();
+  const G4double halfX = box->GetXHalfLength();
+  const G4double halfY = box->GetYHalfLength();
+  const G4double halfZ = box->GetZHalfLength();
+
+  long nStep = 0;
+  G4Timer timer;
+  timer.Start();
+
+  for (int i = 0; i < nRay; i++) {
+    G4ThreeVector pos = center + G4ThreeVector((2.*G4UniformRand()-1.)*halfX, (2.*G4UniformRand()-1.)*halfY, -halfZ);
+    G4ThreeVector dir = G4ThreeVector(0.01*(2.*G4UniformRand()-1.), 0.01*(2.*G4UniformRand()-1.), 1.).unit();
+
+    G4VPhysicalVolume* vol = navigator.LocateGlobalPointAndSetup(pos,&dir,false,false);
+    G4double safety = 0.;
+
+    while ( vol && pos.z() < center.z() + halfZ ) {
+      G4double proposed = charged ? -fPhysicsStep*std::log(1.-G4UniformRand()) : kInfinity;
+      G4double step = navigator.ComputeStep(pos,dir,proposed,safety);
+
+      if ( step >= proposed ) {
+        // physics limited: the navigator only has to relocate within the volume
+        pos += proposed*dir;
+        navigator.LocateGlobalPointWithinVolume(pos);
+      } else {
+        pos += step*dir;
+        navigator.SetGeometricallyLimitedStep();
+        vol = navigator.LocateGlobalPointAndSetup(pos,&dir,true);
+      }
+      nStep++;
+    }
+  }
+
+  timer.Stop();
+
+  G4cout << "DRsimNavigationBenchmark: " << nRay << ( charged ? " charged" : " geantino" ) << " rays through "
+         << fModule->GetName() << ", " << nStep << " steps, "
+         << ( nStep > 0 ? timer.GetRealElapsed()/(G4double)nStep*1.e6 : 0. ) << " us/step" << G4endl;
+}
@@ -0,0 +1,235 @@
+#include "DRsimPhotonLUT.hh"
+
+#include "G4AutoLock.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4PhysicalConstants.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+  G4Mutex DRsimPhotonLUTMutex = G4MUTEX_INITIALIZER;
+  const char kMagic[8] = "DRLUT";
+
+  // bin of a normalized CDF for a uniform random number
+  G4int sampleCDF(const G4float* cdf, G4int nBin) {
+    return std::min( (G4int)(std::upper_bound(cdf,cdf+nBin,(G4float)G4UniformRand()) - cdf), nBin-1 );
+  }
+}
+
+G4String DRsimPhotonLUT::sMode = "off";
+G4String DRsimPhotonLUT::sFilename = "photonLUT.bin";
+G4double DRsimPhotonLUT::sFiberLength = 2500.*mm;
+DRsimPhotonLUT* DRsimPhotonLUT::sShared = 0;
+
+G4ThreadLocal DRsimPhotonLUTBuilder* DRsimPhotonLUTBuilder::sThreadBuilder = 0;
+DRsimPhotonLUTBuilder* DRsimPhotonLUTBuilder::sMerged = 0;
+
+G4String DRsimPhotonLUT::Path() {
+  if ( sFilename.empty() || sFilename[0]=='/' ) return sFilename;
+
+  char cwd[4096];
+  if ( !getcwd(cwd,sizeof(cwd)) ) return sFilename;
+
+  return G4String(cwd)+"/"+sFilename;
+}
+
+const DRsimPhotonLUT* DRsimPhotonLUT::GetShared() {
+  G4AutoLock lock(&DRsimPhotonLUTMutex);
+
+  if (!sShared) sShared = new DRsimPhotonLUT(Path());
+
+  return sShared;
+}
+
+void DRsimPhotonLUT::ReleaseShared() {
+  G4AutoLock lock(&DRsimPhotonLUTMutex);
+
+  delete sShared;
+  sShared = 0;
+}
+
+DRsimPhotonLUT::DRsimPhotonLUT(const G4String& filename)
+: fMap(0), fMapSize(0), fHeader(0), fData(0), fRecordSize(0)
+{
+  int fd = open(filename.c_str(),O_RDONLY);
+  struct stat st;
+
+  if ( fd < 0 || fstat(fd,&st) != 0 || (size_t)st.st_size < sizeof(DRsimPhotonLUTHeader) ) {
+    if ( fd >= 0 ) close(fd);
+    G4Exception("DRsimPhotonLUT::DRsimPhotonLUT()", "DRsimCode007", FatalException, ("cannot read photon LUT "+filename+", calibrate it or set /DRsim/action/photonLUTFile").c_str());
+    return;
+  }
+
+  fMapSize = st.st_size;
+  fMap = mmap(0,fMapSize,PROT_READ,MAP_SHARED,fd,0);
+  close(fd);
+
+  if ( fMap==MAP_FAILED ) {
+    fMap = 0;
+    G4Exception("DRsimPhotonLUT::DRsimPhotonLUT()", "DRsimCode007", FatalException, ("cannot map photon LUT "+filename).c_str());
+    return;
+  }
+
+  fHeader = static_cast<const DRsimPhotonLUTHeader*>(fMap);
+  if ( std::memcmp(fHeader->magic,kMagic,sizeof(kMagic)) != 0 || fHeader->version != kVersion ) {
+    G4Exception("DRsimPhotonLUT::DRsimPhotonLUT()", "DRsimCode007", FatalException, (filename+" is not a photon LUT of version "+std::to_string(kVersion)+", calibrate it again").c_str());
+    return;
+  }
+
+  fData = reinterpret_cast<const G4float*>( static_cast<const char*>(fMap) + sizeof(DRsimPhotonLUTHeader) );
+  fRecordSize = 1 + fHeader->nTime + fHeader->nWav;
+
+  size_t expected = sizeof(DRsimPhotonLUTHeader) + sizeof(G4float)*(size_t)fHeader->nType*fHeader->nDepth*fRecordSize;
+  if ( fMapSize != expected ) {
+    G4Exception("DRsimPhotonLUT::DRsimPhotonLUT()", "DRsimCode007", FatalException, (filename+" is truncated or has trailing data").c_str());
+    return;
+  }
+
+  // depth bins are fractions of the fiber length the table was calibrated with
+  if ( fHeader->nType != DRsimPhotonLUTBuilder::kNType || std::abs(fHeader->fiberLength - sFiberLength/mm) > 1.e-3 ) {
+    G4ExceptionDescription msg;
+    msg << filename << " holds " << fHeader->nType << " fiber types of " << fHeader->fiberLength << " mm, the geometry has "
+        << DRsimPhotonLUTBuilder::kNType << " of " << sFiberLength/mm << " mm, calibrate it again" << G4endl;
+    G4Exception("DRsimPhotonLUT::DRsimPhotonLUT()", "DRsimCode007", FatalException, msg);
+  }
+}
+
+DRsimPhotonLUT::~DRsimPhotonLUT() {
+  if (fMap) munmap(fMap,fMapSize);
+}
+
+G4int DRsimPhotonLUT::DepthBin(G4double distance) const {
+  G4int bin = (G4int)( distance/mm / fHeader->fiberLength * fHeader->nDepth );
+
+  return std::max( 0, std::min(bin,fHeader->nDepth-1) );
+}
+
+G4double DRsimPhotonLUT::SampleDelay(G4int type, G4int depthBin) const {
+  const G4float* cdf = record(type,depthBin) + 1;
+  G4int bin = sampleCDF(cdf,fHeader->nTime);
+  G4double width = fHeader->timeMax/fHeader->nTime;
+
+  return ( bin + G4UniformRand() )*width*ns;
+}
+
+G4double DRsimPhotonLUT::SampleEnergy(G4int type, G4int depthBin) const {
+  const G4float* cdf = record(type,depthBin) + 1 + fHeader->nTime;
+  G4int bin = sampleCDF(cdf,fHeader->nWav);
+  G4double width = (fHeader->wavStart-fHeader->wavEnd)/fHeader->nWav;
+  G4double wavlen = fHeader->wavStart - ( bin + G4UniformRand() )*width;
+
+  return h_Planck*c_light/(wavlen*nm);
+}
+
+DRsimPhotonLUTBuilder::DRsimPhotonLUTBuilder(G4double fiberLength)
+: fFiberLength(fiberLength), fTimeMax(40.*ns), fWavStart(900.*nm), fWavEnd(300.*nm),
+fEdep(kNType*kNDepth,0.), fNpe(kNType*kNDepth,0.), fTime(kNType*kNDepth*kNTime,0.), fWav(kNType*kNDepth*kNWav,0.)
+{}
+
+DRsimPhotonLUTBuilder* DRsimPhotonLUTBuilder::GetThreadBuilder() {
+  if (!sThreadBuilder) sThreadBuilder = new DRsimPhotonLUTBuilder(DRsimPhotonLUT::sFiberLength);
+
+  return sThreadBuilder;
+}
+
+void DRsimPhotonLUTBuilder::MergeThread() {
+  if (!sThreadBuilder) return;
+
+  G4AutoLock lock(&DRsimPhotonLUTMutex);
+
+  if (!sMerged) sMerged = new DRsimPhotonLUTBuilder(sThreadBuilder->fFiberLength);
+  sMerged->Merge(*sThreadBuilder);
+
+  delete sThreadBuilder;
+  sThreadBuilder = 0;
+}
+
+void DRsimPhotonLUTBuilder::WriteMerged(const G4String& filename) {
+  G4AutoLock lock(&DRsimPhotonLUTMutex);
+
+  if (!sMerged) return;
+
+  sMerged->Write(filename);
+  delete sMerged;
+  sMerged = 0;
+}
+
+G4int DRsimPhotonLUTBuilder::depthBin(G4double distance) const {
+  G4int bin = (G4int)( distance / fFiberLength * kNDepth );
+
+  return std::max( 0, std::min(bin,kNDepth-1) );
+}
+
+void DRsimPhotonLUTBuilder::FillEdep(G4int type, G4double distance, G4double edep) {
+  fEdep[type*kNDepth + depthBin(distance)] += edep/MeV;
+}
+
+void DRsimPhotonLUTBuilder::FillPhoton(G4int type, G4double distance, G4double delay, G4double energy, G4int weight) {
+  G4int idx = type*kNDepth + depthBin(distance);
+  fNpe[idx] += weight;
+
+  G4int timeBin = std::max( 0, std::min( (G4int)(delay/fTimeMax*kNTime), kNTime-1 ) );
+  fTime[idx*kNTime + timeBin] += weight;
+
+  G4double wavlen = h_Planck*c_light/energy;
+  G4int wavBin = std::max( 0, std::min( (G4int)( (fWavStart-wavlen)/(fWavStart-fWavEnd)*kNWav ), kNWav-1 ) );
+  fWav[idx*kNWav + wavBin] += weight;
+}
+
+void DRsimPhotonLUTBuilder::Merge(const DRsimPhotonLUTBuilder& other) {
+  for (size_t i = 0; i < fEdep.size(); i++) fEdep[i] += other.fEdep[i];
+  for (size_t i = 0; i < fNpe.size(); i++) fNpe[i] += other.fNpe[i];
+  for (size_t i = 0; i < fTime.size(); i++) fTime[i] += other.fTime[i];
+  for (size_t i = 0; i < fWav.size(); i++) fWav[i] += other.fWav[i];
+}
+
+G4bool DRsimPhotonLUTBuilder::Write(const G4String& filename) const {
+  DRsimPhotonLUTHeader header;
+  std::memcpy(header.magic,kMagic,sizeof(kMagic));
+  header.version = DRsimPhotonLUT::kVersion;
+  header.nType = kNType;
+  header.nDepth = kNDepth;
+  header.nTime = kNTime;
+  header.nWav = kNWav;
+  header.fiberLength = fFiberLength/mm;
+  header.timeMax = fTimeMax/ns;
+  header.wavStart = fWavStart/nm;
+  header.wavEnd = fWavEnd/nm;
+
+  std::ofstream out(filename,std::ios::binary);
+  out.write(reinterpret_cast<const char*>(&header),sizeof(header));
+
+  std::vector<G4float> record(1+kNTime+kNWav);
+
+  for (G4int idx = 0; idx < kNType*kNDepth; idx++) {
+    record[0] = fEdep[idx] > 0. ? fNpe[idx]/fEdep[idx] : 0.;
+
+    // cumulative distributions, left at zero when no photon was seen
+    G4double sum = 0.;
+    for (G4int i = 0; i < kNTime; i++) { sum += fTime[idx*kNTime+i]; record[1+i] = sum; }
+    for (G4int i = 0; i < kNTime && sum > 0.; i++) record[1+i] /= sum;
+
+    sum = 0.;
+    for (G4int i = 0; i < kNWav; i++) { sum += fWav[idx*kNWav+i]; record[1+kNTime+i] = sum; }
+    for (G4int i = 0; i < kNWav && sum > 0.; i++) record[1+kNTime+i] /= sum;
+
+    out.write(reinterpret_cast<const char*>(record.data()),sizeof(G4float)*record.size());
+  }
+
+  if (!out.good()) {
+    G4Exception("DRsimPhotonLUTBuilder::Write()", "DRsimCode007", JustWarning, ("cannot write photon LUT "+filename).c_str());
+    return false;
+  }
+
+  G4cout << "DRsimPhotonLUTBuilder: photon LUT written to " << filename << G4endl;
+  return true;
+}
@@ -0,0 +1,103 @@
+#include "DRsimPhysicsProfile.hh"
+
+#include "G4StateManager.hh"
+#include "G4BuilderType.hh"
+#include "G4SystemOfUnits.hh"
+
+G4String DRsimPhysicsProfile::sProfile = "full-optical";
+G4double DRsimPhysicsProfile::sAbsorberCut = 0.7*mm; // full-optical, see Apply()
+G4double DRsimPhysicsProfile::sFiberCoreCut = 0.1*mm;
+DRsimPhysicsProfile* DRsimPhysicsProfile::sInstance = 0;
+
+DRsimPhysicsProfile::DRsimPhysicsProfile(G4VModularPhysicsList* physicsList, G4OpticalPhysics* opticalPhysics)
+: fMessenger(0), fPhysicsList(physicsList), fOpticalPhysics(opticalPhysics), fFastSimulationPhysics(0), fApplied(false)
+{
+  sInstance = this;
+  DefineCommands();
+}
+
+DRsimPhysicsProfile::~DRsimPhysicsProfile() {
+  if (fMessenger) delete fMessenger;
+  if (sInstance==this) sInstance = 0;
+}
+
+void DRsimPhysicsProfile::RequestFastSimulation() {
+  if ( !sInstance || sInstance->fFastSimulationPhysics ) return;
+
+  if ( G4StateManager::GetStateManager()->GetCurrentState() != G4State_PreInit ) {
+    G4Exception("DRsimPhysicsProfile::RequestFastSimulation()", "DRsimCode008", JustWarning, "fast simulation physics can only be registered before /run/initialize");
+    return;
+  }
+
+  sInstance->fFastSimulationPhysics = new G4FastSimulationPhysics();
+  sInstance->fFastSimulationPhysics->ActivateFastSimulation("opticalphoton");
+  sInstance->fPhysicsList->RegisterPhysics(sInstance->fFastSimulationPhysics);
+}
+
+void DRsimPhysicsProfile::Apply(G4String profile) {
+  if ( G4StateManager::GetStateManager()->GetCurrentState() != G4State_PreInit ) {
+    G4Exception("DRsimPhysicsProfile::Apply()", "DRsimCode008", JustWarning, "physics profiles can only be selected before /run/initialize");
+    return;
+  }
+
+  // removed constructors cannot be put back
+  if ( fApplied ) {
+    if ( profile != sProfile ) G4Exception("DRsimPhysicsProfile::Apply()", "DRsimCode008", JustWarning, ("physics profile already set to "+sProfile+", ignoring "+profile).c_str());
+    return;
+  }
+
+  if ( profile=="full-optical" ) {
+    // copper : the Geant4 default, the electrons below it (about 1 MeV) stop before reaching a fiber.
+    // core : below the Cerenkov threshold of electrons in PMMA and polystyrene (~0.18 and ~0.15 MeV);
+    // the default 0.7 mm (several hundred keV) folds those delta rays into the parent's continuous loss
+    sAbsorberCut = 0.7*mm;
+    sFiberCoreCut = 0.1*mm;
+  } else if ( profile=="no-optical" || profile=="EM-only-calo" ) {
+    fPhysicsList->RemovePhysics(fOpticalPhysics);
+
+    if ( profile=="EM-only-calo" ) {
+      fPhysicsList->RemovePhysics(bEmExtra);
+      fPhysicsList->RemovePhysics(bHadronElastic);
+      fPhysicsList->RemovePhysics(bHadronInelastic);
+      fPhysicsList->RemovePhysics(bStopping);
+      fPhysicsList->RemovePhysics(bIons);
+    }
+
+    if ( profile=="no-optical" ) {
+      // only the module sums of Edep are used; a secondary below the cut deposits within 2 mm,
+      // small against the 90 mm module and the ~16 mm Moliere radius of copper. Without light
+      // the fibers are just part of that sum and take the same cut
+      sAbsorberCut = 2.*mm;
+      sFiberCoreCut = 2.*mm;
+    } else {
+      // e/gamma studies also read the EdepEle/EdepGamma split, which depends on the produced
+      // secondaries; the Geant4 default keeps it comparable with the copper of full-optical runs
+      sAbsorberCut = 0.7*mm;
+      sFiberCoreCut = 0.7*mm;
+    }
+  } else {
+    G4Exception("DRsimPhysicsProfile::Apply()", "DRsimCode008", JustWarning, ("unknown physics profile "+profile).c_str());
+    return;
+  }
+
+  sProfile = profile;
+  fApplied = true;
+
+  G4cout << "DRsimPhysicsProfile: " << sProfile << G4endl;
+}
+
+void DRsimPhysicsProfile::DefineCommands() {
+  fMessenger = new G4GenericMessenger(this, "/DRsim/physics/", "physics profile control");
+  G4GenericMessenger::Command& profileCmd = fMessenger->DeclareMethod("profile",&DRsimPhysicsProfile::Apply,"full-optical, no-optical or EM-only-calo, set before /run/initialize");
+  profileCmd.SetParameterName("profile",false);
+  profileCmd.SetCandidates("full-optical no-optical EM-only-calo");
+  profileCmd.SetStates(G4State_PreInit);
+
+  G4GenericMessenger::Command& absorberCmd = fMessenger->DeclarePropertyWithUnit("absorberCut","mm",sAbsorberCut,"production cut of the Absorber region (< 0 : default), after /DRsim/physics/profile");
+  absorberCmd.SetParameterName("absorberCut",false);
+  absorberCmd.SetStates(G4State_PreInit);
+
+  G4GenericMessenger::Command& fiberCmd = fMessenger->DeclarePropertyWithUnit("fiberCoreCut","mm",sFiberCoreCut,"production cut of the FiberCore region (< 0 : default), after /DRsim/physics/profile");
+  fiberCmd.SetParameterName("fiberCoreCut",false);
+  fiberCmd.SetStates(G4State_PreInit);
+}
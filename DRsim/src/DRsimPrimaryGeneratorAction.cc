@@ -1,30 +1,39 @@
 #include "DRsimPrimaryGeneratorAction.hh"
 #include "DRsimRunAction.hh"
+#ifdef DRSIM_WITH_PYTHIA8
+#include "Pythia8G4Generator.hh"
+#endif
 
 #include "G4Event.hh"
 #include "G4ParticleTable.hh"
 #include "G4ParticleDefinition.hh"
 #include "G4GenericMessenger.hh"
 #include "G4SystemOfUnits.hh"
-#include "G4AutoLock.hh"
 #include "Randomize.hh"
 // #include "PhysicalConstants.h"
 #include <cmath>
 
-namespace { G4Mutex DRsimPrimaryGeneratorMutex = G4MUTEX_INITIALIZER; }
 int DRsimPrimaryGeneratorAction::sNumEvt = 0;
 G4ThreadLocal int DRsimPrimaryGeneratorAction::sIdxEvt = 0;
+G4ThreadLocal int DRsimPrimaryGeneratorAction::sSubEvt = 0;
+G4ThreadLocal int DRsimPrimaryGeneratorAction::sNumSubEvt = 1;
 
 using namespace std;
-DRsimPrimaryGeneratorAction::DRsimPrimaryGeneratorAction(G4int seed, G4bool useHepMC, G4bool useCalib, G4bool useGPS)
-: G4VUserPrimaryGeneratorAction()
+DRsimPrimaryGeneratorAction::DRsimPrimaryGeneratorAction(G4int seed, G4bool useHepMC, G4bool useCalib, G4bool useGPS, G4bool usePythia)
+: G4VUserPrimaryGeneratorAction(), fPythia(0)
 {
   fSeed = seed;
   fUseHepMC = useHepMC;
   fUseCalib = useCalib;
   fUseGPS = useGPS;
+  fUsePythia = usePythia;
 
-  if (!fUseHepMC) {
+#ifndef DRSIM_WITH_PYTHIA8
+  if (fUsePythia)
+    G4Exception("DRsimPrimaryGeneratorAction::DRsimPrimaryGeneratorAction()", "DRsimCode010", FatalException, "/DRsim/action/usePythia needs a build with -DDRSIM_WITH_PYTHIA8=ON");
+#endif
+
+  if (!fUseHepMC && !fUsePythia) {
     if (fUseGPS) initGPS();
     else initPtcGun();
   }
@@ -58,7 +67,11 @@ void DRsimPrimaryGeneratorAction::initGPS() {
 }
 
 DRsimPrimaryGeneratorAction::~DRsimPrimaryGeneratorAction() {
-  if (!fUseHepMC) {
+#ifdef DRSIM_WITH_PYTHIA8
+  delete fPythia;
+#endif
+
+  if (!fUseHepMC && !fUsePythia) {
     if (fUseGPS) delete fGPS;
     else {
       if (fParticleGun) delete fParticleGun;
@@ -67,25 +80,36 @@ DRsimPrimaryGeneratorAction::~DRsimPrimaryGeneratorAction() {
   }
 }
 
+void DRsimPrimaryGeneratorAction::EndOfRun(G4int nofEvents) {
+  sNumEvt += nofEvents;
+}
+
 void DRsimPrimaryGeneratorAction::GeneratePrimaries(G4Event* event) {
 
   if (fUseGPS) {
-    G4AutoLock lock(&DRsimPrimaryGeneratorMutex);
     fGPS->GeneratePrimaryVertex(event);
-    sIdxEvt = sNumEvt;
-    sNumEvt++;
+    sIdxEvt = sNumEvt + event->GetEventID();
 
     return;
   }
 
+  // the index follows the file so that event_number matches the HepMC event
   if (fUseHepMC) {
-    G4AutoLock lock(&DRsimPrimaryGeneratorMutex);
-    DRsimRunAction::sHepMCreader->GeneratePrimaryVertex(event);
-    sIdxEvt = sNumEvt;
-    sNumEvt++;
+    sIdxEvt = DRsimRunAction::sHepMCreader->GenerateEvent(event,sSubEvt,sNumSubEvt);
+
+    return;
+  }
+
+#ifdef DRSIM_WITH_PYTHIA8
+  if (fUsePythia) {
+    if (!fPythia) fPythia = new Pythia8G4Generator(fSeed);
+
+    sIdxEvt = sNumEvt + event->GetEventID();
+    fPythia->GenerateEvent(event,sIdxEvt);
 
     return;
   }
+#endif
 
   G4double x = (G4UniformRand()-0.5)*fRandX + fX_0;
   G4double y = (G4UniformRand()-0.5)*fRandY + fY_0;
@@ -100,10 +124,8 @@ void DRsimPrimaryGeneratorAction::GeneratePrimaries(G4Event* event) {
 
   fParticleGun->SetParticleMomentumDirection(fDirection);
 
-  G4AutoLock lock(&DRsimPrimaryGeneratorMutex);
   fParticleGun->GeneratePrimaryVertex(event);
-  sIdxEvt = sNumEvt;
-  sNumEvt++;
+  sIdxEvt = sNumEvt + event->GetEventID();
 }
 
 void DRsimPrimaryGeneratorAction::DefineCommands() {
@@ -0,0 +1,60 @@
+#include "DRsimPropertyTable.hh"
+
+#include "G4Timer.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <cmath>
+
+DRsimPropertyTable::DRsimPropertyTable()
+: fVector(0), fEmin(0.), fInvStep(0.), fLast(0.)
+{}
+
+DRsimPropertyTable::DRsimPropertyTable(G4MaterialPropertyVector* vec, G4int nPoint)
+: fVector(vec), fEmin(0.), fInvStep(0.), fLast(0.)
+{
+  if ( nPoint < 2 ) return;
+
+  fEmin = vec->GetMinLowEdgeEnergy();
+  G4double step = ( vec->GetMaxLowEdgeEnergy() - fEmin )/(nPoint-1);
+  fInvStep = 1./step;
+  fLast = nPoint-1;
+
+  fValues.reserve(nPoint);
+  for (G4int i = 0; i < nPoint; i++) fValues.push_back( vec->Value( std::min(fEmin + i*step, vec->GetMaxLowEdgeEnergy()) ) );
+}
+
+void DRsimPropertyTable::Benchmark(G4MaterialPropertyVector* vec, const G4String& name, G4int nPoint, G4int nLookup) {
+  if ( !vec || nLookup < 1 ) return;
+
+  DRsimPropertyTable table(vec,nPoint);
+
+  // drawn up front so that only the lookups are timed
+  std::vector<G4double> energies(nLookup);
+  for (auto& en : energies) en = vec->GetMinLowEdgeEnergy() + G4UniformRand()*( vec->GetMaxLowEdgeEnergy() - vec->GetMinLowEdgeEnergy() );
+
+  G4Timer timer;
+  G4double sumG4 = 0.;
+  timer.Start();
+  for (const auto en : energies) sumG4 += vec->Value(en);
+  timer.Stop();
+  G4double timeG4 = timer.GetRealElapsed();
+
+  G4double sumTable = 0.;
+  timer.Start();
+  for (const auto en : energies) sumTable += table.Value(en);
+  timer.Stop();
+  G4double timeTable = timer.GetRealElapsed();
+
+  G4double maxDiff = 0.;
+  G4double maxValue = 0.;
+  for (const auto en : energies) {
+    maxDiff = std::max( maxDiff, std::abs( table.Value(en) - vec->Value(en) ) );
+    maxValue = std::max( maxValue, std::abs( vec->Value(en) ) );
+  }
+
+  // the sums keep the timed loops from being optimised away
+  G4cout << "DRsimPropertyTable: " << name << " (" << vec->GetVectorLength() << " points -> " << nPoint << ") "
+         << timeG4/nLookup*1.e9 << " ns/lookup G4MaterialPropertyVector, " << timeTable/nLookup*1.e9 << " ns/lookup dense, "
+         << "max. rel. difference " << ( maxValue > 0. ? maxDiff/maxValue : 0. ) << " (checksum " << sumG4-sumTable << ")" << G4endl;
+}
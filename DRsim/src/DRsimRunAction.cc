@@ -1,16 +1,29 @@
 #include "DRsimRunAction.hh"
 #include "DRsimEventAction.hh"
+#include "DRsimPhotonLUT.hh"
+#include "DRsimPrimaryGeneratorAction.hh"
+#include "DRsimStackingAction.hh"
 #include "G4AutoLock.hh"
+#include "G4Run.hh"
 #include "G4Threading.hh"
+#include "G4ProcessTable.hh"
 
 #include <vector>
 
 using namespace std;
 
-namespace { G4Mutex DRsimRunActionMutex = G4MUTEX_INITIALIZER; }
+namespace {
+  G4Mutex DRsimRunActionMutex = G4MUTEX_INITIALIZER;
+  G4int outputPrescale = 0; // prescale the open output files were written with
+}
 HepMCG4Reader* DRsimRunAction::sHepMCreader = 0;
-RootInterface<DRsimInterface::DRsimEventData>* DRsimRunAction::sRootIO = 0;
+DRsimRootInterface* DRsimRunAction::sRootIO = 0;
+DRsimEventWriter* DRsimRunAction::sWriter = 0;
+G4ThreadLocal DRsimRootInterface* DRsimRunAction::sThreadRootIO = 0;
 int DRsimRunAction::sNumEvt = 0;
+G4bool DRsimRunAction::sUseV2 = false;
+G4int DRsimRunAction::sWriterBuffer = 64;
+G4bool DRsimRunAction::sPerThreadOutput = false;
 
 DRsimRunAction::DRsimRunAction(G4int seed, G4String filename, G4bool useHepMC)
 : G4UserRunAction()
@@ -21,11 +34,6 @@ DRsimRunAction::DRsimRunAction(G4int seed, G4String filename, G4bool useHepMC)
 
   G4AutoLock lock(&DRsimRunActionMutex);
 
-  if (!sRootIO) {
-    sRootIO = new RootInterface<DRsimInterface::DRsimEventData>(fFilename+"_"+std::to_string(fSeed)+".root", true);
-    sRootIO->create("DRsim","DRsimEventData");
-  }
-
   if (fUseHepMC && !sHepMCreader) {
     sHepMCreader = new HepMCG4Reader(fSeed,fFilename);
   }
@@ -46,13 +54,97 @@ DRsimRunAction::~DRsimRunAction() {
       delete sRootIO;
       sRootIO = 0;
     }
+
+    DRsimPhotonLUT::ReleaseShared();
+  } else if (sThreadRootIO) {
+    sThreadRootIO->write();
+    sThreadRootIO->close();
+    delete sThreadRootIO;
+    sThreadRootIO = 0;
   }
 }
 
-void DRsimRunAction::BeginOfRunAction(const G4Run*) {
+DRsimRootInterface* DRsimRunAction::openOutput(G4String filename) {
+  DRsimRootInterface* rootIO = new DRsimRootInterface(filename, true);
+  if (sUseV2) rootIO->createV2("DRsim","DRsimEventData");
+  else rootIO->create("DRsim","DRsimEventData");
+  rootIO->setPhotonPrescale(DRsimStackingAction::sPhotonPrescale);
 
+  return rootIO;
 }
 
-void DRsimRunAction::EndOfRunAction(const G4Run*) {
+void DRsimRunAction::BeginOfRunAction(const G4Run* run) {
+  // opened here rather than in the constructor so that /DRsim/action/ settings from the macro apply
+  G4bool perThread = sPerThreadOutput && G4Threading::IsMultithreadedApplication();
+
+  // a split event must not straddle two runs, the writer of the first one could not complete it
+  if (IsMaster() && sHepMCreader && sHepMCreader->GetSubEvents() > 1 && run->GetNumberOfEventToBeProcessed() % sHepMCreader->GetSubEvents() != 0) {
+    G4ExceptionDescription msg;
+    msg << "/run/beamOn " << run->GetNumberOfEventToBeProcessed() << " is not a multiple of /DRsim/hepMC/subEvents " << sHepMCreader->GetSubEvents()
+        << ", each HepMC event takes that many G4 events" << G4endl;
+    G4Exception("DRsimRunAction::BeginOfRunAction()", "DRsimCode012", FatalException, msg);
+  }
+
+  // the parts of a split event end up on different workers, only the shared writer can merge them
+  if (perThread && sHepMCreader && sHepMCreader->GetSubEvents() > 1) {
+    if (IsMaster()) G4Exception("DRsimRunAction::BeginOfRunAction()", "DRsimCode011", JustWarning, "/DRsim/hepMC/subEvents needs the shared writer, perThreadOutput ignored");
+    perThread = false;
+  }
+
+  // the output files span all runs of the job but hold a single prescale
+  if (IsMaster()) {
+    if (outputPrescale > 0 && outputPrescale != DRsimStackingAction::sPhotonPrescale) {
+      G4ExceptionDescription msg;
+      msg << "/DRsim/action/photonPrescale changed from " << outputPrescale << " to " << DRsimStackingAction::sPhotonPrescale
+          << " after the output was opened, its header keeps " << outputPrescale << G4endl;
+      G4Exception("DRsimRunAction::BeginOfRunAction()", "DRsimCode003", JustWarning, msg);
+    }
+    if (outputPrescale==0) outputPrescale = DRsimStackingAction::sPhotonPrescale;
+  }
+
+  if (IsMaster() && !perThread) {
+    G4AutoLock lock(&DRsimRunActionMutex);
+
+    if (!sRootIO) sRootIO = openOutput(fFilename+"_"+std::to_string(fSeed)+".root");
 
+    // HepMC events are numbered by the reader, the others by the generator action
+    sWriter = new DRsimEventWriter(sRootIO,sHepMCreader ? sNumEvt : DRsimPrimaryGeneratorAction::sNumEvt,sWriterBuffer);
+  }
+
+  // each worker owns its file, events are put back in order by mergeDRsim
+  if (!IsMaster() && perThread && !sThreadRootIO) {
+    G4String threadName = fFilename+"_"+std::to_string(fSeed)+"_t"+std::to_string(G4Threading::G4GetThreadId())+".root";
+
+    G4AutoLock lock(&DRsimRunActionMutex); // TFile creation touches ROOT's global lists
+    sThreadRootIO = openOutput(threadName);
+  }
+
+  // photons come from the LUT, the process table is per thread
+  if ( DRsimPhotonLUT::IsUsing() ) {
+    if (IsMaster()) DRsimPhotonLUT::GetShared(); // fail early on a bad file
+    G4ProcessTable::GetProcessTable()->SetProcessActivation("Cerenkov",false);
+    G4ProcessTable::GetProcessTable()->SetProcessActivation("Scintillation",false);
+  }
+}
+
+void DRsimRunAction::EndOfRunAction(const G4Run* run) {
+  if ( DRsimPhotonLUT::IsCalibrating() ) {
+    DRsimPhotonLUTBuilder::MergeThread();
+    if (IsMaster()) DRsimPhotonLUTBuilder::WriteMerged(DRsimPhotonLUT::Path());
+  }
+
+  // workers are done by the time the master gets here; flush what is still buffered
+  if (IsMaster()) {
+    DRsimEventAction::PrintRunPhotonCounts();
+    // all event IDs of the run are taken, also those an aborted run never got to
+    DRsimPrimaryGeneratorAction::EndOfRun(run->GetNumberOfEventToBeProcessed());
+    if (sHepMCreader) sHepMCreader->EndOfRun();
+  }
+
+  if (IsMaster() && sWriter) {
+    sWriter->finish();
+    sNumEvt = sWriter->GetNextIdx();
+    delete sWriter;
+    sWriter = 0;
+  }
 }
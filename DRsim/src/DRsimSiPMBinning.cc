@@ -0,0 +1,33 @@
+#include "DRsimSiPMBinning.hh"
+
+#include <algorithm>
+
+DRsimSiPMBinning::DRsimSiPMBinning()
+: fTimeBin(0), fTimeStart(0.), fTimeStep(0.)
+{}
+
+DRsimSiPMBinning::DRsimSiPMBinning(G4int wavBin, G4float wavlenStart, G4float wavlenStep, G4int timeBin, G4float timeStart, G4float timeStep)
+: fTimeBin(timeBin), fTimeStart(timeStart), fTimeStep(timeStep)
+{
+  // wavelength runs downward from wavlenStart, so the energy edges ascend
+  for (int i = 0; i < wavBin+1; i++) fWavEdgeE.push_back( wavToE( (wavlenStart - (float)i*wavlenStep)*nm ) );
+  for (int i = 0; i < timeBin+1; i++) fTimeEdges.push_back( (timeStart + (float)i*timeStep)*ns );
+}
+
+G4int DRsimSiPMBinning::findWavBin(G4double en) const {
+  return std::upper_bound(fWavEdgeE.begin(),fWavEdgeE.end(),en) - fWavEdgeE.begin();
+}
+
+G4int DRsimSiPMBinning::findTimeBin(G4double stepTime) const {
+  if ( stepTime < fTimeEdges.front() ) return 0;
+  if ( !(stepTime < fTimeEdges.back()) ) return fTimeBin+1;
+
+  // arithmetic guess, then settle against the exact (float-rounded) edges
+  G4int i = (G4int)( (stepTime/ns - fTimeStart)/fTimeStep ) + 1;
+  if (i < 1) i = 1;
+  if (i > fTimeBin) i = fTimeBin;
+  while ( i > 1 && stepTime < fTimeEdges[i-1] ) i--;
+  while ( !(stepTime < fTimeEdges[i]) ) i++;
+
+  return i;
+}
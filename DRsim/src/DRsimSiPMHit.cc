@@ -2,7 +2,7 @@
 
 G4ThreadLocal G4Allocator<DRsimSiPMHit>* DRsimSiPMHitAllocator = 0;
 
-DRsimSiPMHit::DRsimSiPMHit(G4int wavBin, G4int timeBin)
+DRsimSiPMHit::DRsimSiPMHit(const DRsimBinnedHist& wavHist, const DRsimBinnedHist& timeHist)
 : G4VHit(),
   fSiPMnum(0),
   fPhotons(0),
@@ -12,8 +12,8 @@ DRsimSiPMHit::DRsimSiPMHit(G4int wavBin, G4int timeBin)
   fInnerR(0.),
   fTowerH(0.),
   fSiPMXY(std::make_pair(-1,-1)),
-  fWavBin(wavBin),
-  fTimeBin(timeBin)
+  fWavlenHist(wavHist),
+  fTimeHist(timeHist)
 {}
 
 DRsimSiPMHit::~DRsimSiPMHit() {}
@@ -28,8 +28,8 @@ DRsimSiPMHit::DRsimSiPMHit(const DRsimSiPMHit &right)
   fInnerR = right.fInnerR;
   fTowerH = right.fTowerH;
   fSiPMXY = right.fSiPMXY;
-  fWavlenSpectrum = right.fWavlenSpectrum;
-  fTimeStruct = right.fTimeStruct;
+  fWavlenHist = right.fWavlenHist;
+  fTimeHist = right.fTimeHist;
 }
 
 const DRsimSiPMHit& DRsimSiPMHit::operator=(const DRsimSiPMHit &right) {
@@ -41,8 +41,8 @@ const DRsimSiPMHit& DRsimSiPMHit::operator=(const DRsimSiPMHit &right) {
   fInnerR = right.fInnerR;
   fTowerH = right.fTowerH;
   fSiPMXY = right.fSiPMXY;
-  fWavlenSpectrum = right.fWavlenSpectrum;
-  fTimeStruct = right.fTimeStruct;
+  fWavlenHist = right.fWavlenHist;
+  fTimeHist = right.fTimeHist;
   return *this;
 }
 
@@ -53,15 +53,3 @@ G4bool DRsimSiPMHit::operator==(const DRsimSiPMHit &right) const {
 void DRsimSiPMHit::Draw() {}
 
 void DRsimSiPMHit::Print() {}
-
-void DRsimSiPMHit::CountWavlenSpectrum(DRsimInterface::hitRange range) {
-  auto it = fWavlenSpectrum.find(range);
-  if (it==fWavlenSpectrum.end()) fWavlenSpectrum.insert(std::make_pair(range,1));
-  else it->second++;
-}
-
-void DRsimSiPMHit::CountTimeStruct(DRsimInterface::hitRange range) {
-  auto it = fTimeStruct.find(range);
-  if (it==fTimeStruct.end()) fTimeStruct.insert(std::make_pair(range,1));
-  else it->second++;
-}
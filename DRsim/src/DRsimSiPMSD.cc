@@ -1,14 +1,26 @@
 #include "DRsimSiPMSD.hh"
 #include "DRsimSiPMHit.hh"
 #include "DRsimDetectorConstruction.hh"
+#include "DRsimPhotonLUT.hh"
+#include "DRsimStackingAction.hh"
+#include "RecoInterface.h"
 
 #include "G4HCofThisEvent.hh"
 #include "G4SDManager.hh"
 #include "G4ParticleDefinition.hh"
 #include "G4ParticleTypes.hh"
+#include "G4NavigationHistory.hh"
+#include "G4Box.hh"
+#include "G4Threading.hh"
+#include "G4Timer.hh"
+
+#include <algorithm>
 
 using namespace std;
 
+G4String DRsimSiPMSD::sRecordPath = "";
+G4ThreadLocal std::ofstream* DRsimSiPMSD::sRecord = 0;
+
 DRsimSiPMSD::DRsimSiPMSD(const G4String& name, const G4String& hitsCollectionName, DRsimInterface::DRsimModuleProperty ModuleProp)
 : G4VSensitiveDetector(name), fHitCollection(0), fHCID(-1), fWavBin(60), fTimeBin(600),
 fModuleNum(-1), fWavlenStart(900.), fWavlenEnd(300.), fTimeStart(10.), fTimeEnd(70.)
@@ -17,6 +29,12 @@ fModuleNum(-1), fWavlenStart(900.), fWavlenEnd(300.), fTimeStart(10.), fTimeEnd(
   fWavlenStep = (fWavlenStart-fWavlenEnd)/(float)fWavBin;
   fTimeStep = (fTimeEnd-fTimeStart)/(float)fTimeBin;
 
+  // wavelength axis runs downward from fWavlenStart
+  fWavlenHist = DRsimBinnedHist(fWavBin,fWavlenStart,-fWavlenStep);
+  fTimeHist = DRsimBinnedHist(fTimeBin,fTimeStart,fTimeStep);
+
+  fBinning = DRsimSiPMBinning(fWavBin,fWavlenStart,fWavlenStep,fTimeBin,fTimeStart,fTimeStep);
+
   fModuleNum = ModuleProp.ModuleNum;
   fTowerXY = ModuleProp.towerXY;
 }
@@ -24,60 +42,95 @@ fModuleNum(-1), fWavlenStart(900.), fWavlenEnd(300.), fTimeStart(10.), fTimeEnd(
 DRsimSiPMSD::~DRsimSiPMSD() {}
 
 void DRsimSiPMSD::Initialize(G4HCofThisEvent* hce) {
-  fHitCollection = new DRsimSiPMHitsCollection(SensitiveDetectorName,collectionName[0]);
+  resetHits();
   if (fHCID<0) { fHCID = GetCollectionID(0); }
   hce->AddHitsCollection(fHCID,fHitCollection);
+
+  if ( !sRecordPath.empty() ) record({fModuleNum,-1,0.,0.});
+}
+
+void DRsimSiPMSD::resetHits() {
+  fHitCollection = new DRsimSiPMHitsCollection(SensitiveDetectorName,collectionName[0]);
+  fHitIndex.assign(fTowerXY.first*fTowerXY.second,NULL);
 }
 
 G4bool DRsimSiPMSD::ProcessHits(G4Step* step, G4TouchableHistory*) {
   if(step->GetTrack()->GetDefinition() != G4OpticalPhoton::OpticalPhotonDefinition()) return false;
 
   G4int SiPMnum = step->GetPostStepPoint()->GetTouchable()->GetVolume(1)->GetCopyNo();
-  G4int nofHits = fHitCollection->entries();
   G4double hitTime = step->GetPostStepPoint()->GetGlobalTime();
   G4double energy = step->GetTrack()->GetTotalEnergy();
 
-  DRsimSiPMHit* hit = NULL;
-
-  for (G4int i = 0; i < nofHits; i++) {
-
-    // G4cout << " Hit iteration : " 
-    //        << i << " " 
-    //        << SiPMnum << " " 
-    //        << (*fHitCollection)[i]->GetSiPMnum() << " " 
-    //        << fModuleNum << " " 
-    //        << (*fHitCollection)[i]->GetModuleNum() << " "
-    //        << G4endl;
-    
-    if ( (*fHitCollection)[i]->GetSiPMnum() == SiPMnum && (*fHitCollection)[i]->GetModuleNum() == fModuleNum ) {
-      hit = (*fHitCollection)[i];
-      break;
-    }
+  if ( SiPMnum < 0 || SiPMnum >= (G4int)fHitIndex.size() ) {
+    G4ExceptionDescription msg;
+    msg << "SiPM copy number " << SiPMnum << " out of range for module " << fModuleNum << G4endl;
+    G4Exception("DRsimSiPMSD::ProcessHits()", "DRsimCode002", JustWarning, msg);
+    return false;
   }
 
-  if (hit==NULL) {
-    hit = new DRsimSiPMHit(fWavBin,fTimeBin);
-    hit->SetSiPMnum(SiPMnum);
-    hit->SetModuleNum(fModuleNum);
-    hit->SetTowerXY(fTowerXY);
-    hit->SetSiPMXY(findSiPMXY(SiPMnum,fTowerXY));
-    hit->SetSiPMpos(step->GetPostStepPoint()->GetTouchableHandle()->GetHistory()->GetTopTransform().Inverse().TransformPoint(G4ThreeVector(0.,0.,0.)));
+  DRsimSiPMHit* hit = fHitIndex[SiPMnum];
+  if (hit==NULL) hit = createHit(SiPMnum,step->GetPostStepPoint()->GetTouchableHandle()->GetHistory()->GetTopTransform().Inverse().TransformPoint(G4ThreeVector(0.,0.,0.)));
+
+  countPhoton(hit,energy,hitTime,DRsimStackingAction::sPhotonPrescale);
 
-    fHitCollection->insert(hit);
+  if ( DRsimPhotonLUT::IsCalibrating() ) fillLUT(step,SiPMnum);
+
+  return true;
+}
+
+void DRsimSiPMSD::fillLUT(const G4Step* step, G4int SiPMnum) {
+  // cath(0) -> cell(1) -> SiPM layer(2) -> PMTG(3), the fibers end on the PMTG front face
+  const G4VTouchable* touchable = step->GetPostStepPoint()->GetTouchable();
+  const G4NavigationHistory* history = touchable->GetHistory();
+  const G4double readoutZ = -static_cast<const G4Box*>(touchable->GetVolume(3)->GetLogicalVolume()->GetSolid())->GetZHalfLength();
+  const G4ThreeVector vertex = history->GetTransform(history->GetDepth()-3).TransformPoint(step->GetTrack()->GetVertexPosition());
+
+  const G4int nofFiber = fTowerXY.second;
+  const G4int type = RecoInterface::IsCerenkov(SiPMnum/nofFiber,SiPMnum%nofFiber) ? 1 : 0;
+
+  DRsimPhotonLUTBuilder::GetThreadBuilder()->FillPhoton(type,readoutZ-vertex.z(),step->GetPostStepPoint()->GetLocalTime(),step->GetTrack()->GetTotalEnergy(),DRsimStackingAction::sPhotonPrescale);
+}
+
+void DRsimSiPMSD::AddFastHit(G4int SiPMnum, G4double energy, G4double hitTime, const G4ThreeVector& SiPMpos, G4int weight) {
+  if ( SiPMnum < 0 || SiPMnum >= (G4int)fHitIndex.size() ) {
+    G4ExceptionDescription msg;
+    msg << "SiPM number " << SiPMnum << " out of range for module " << fModuleNum << G4endl;
+    G4Exception("DRsimSiPMSD::AddFastHit()", "DRsimCode002", JustWarning, msg);
+    return;
   }
 
-  hit->photonCount();
+  DRsimSiPMHit* hit = fHitIndex[SiPMnum];
+  if (hit==NULL) hit = createHit(SiPMnum,SiPMpos);
 
-  DRsimInterface::hitRange wavRange = findWavRange(energy);
-  hit->CountWavlenSpectrum(wavRange);
+  countPhoton(hit,energy,hitTime,weight);
+}
 
-  DRsimInterface::hitRange timeRange = findTimeRange(hitTime);
-  hit->CountTimeStruct(timeRange);
+DRsimSiPMHit* DRsimSiPMSD::createHit(G4int SiPMnum, const G4ThreeVector& SiPMpos) {
+  DRsimSiPMHit* hit = new DRsimSiPMHit(fWavlenHist,fTimeHist);
+  hit->SetSiPMnum(SiPMnum);
+  hit->SetModuleNum(fModuleNum);
+  hit->SetTowerXY(fTowerXY);
+  hit->SetSiPMXY(findSiPMXY(SiPMnum,fTowerXY));
+  hit->SetSiPMpos(SiPMpos);
 
-  return true;
+  fHitCollection->insert(hit);
+  fHitIndex[SiPMnum] = hit;
+
+  return hit;
+}
+
+void DRsimSiPMSD::countPhoton(DRsimSiPMHit* hit, G4double energy, G4double hitTime, G4int weight) {
+  if ( !sRecordPath.empty() ) record({fModuleNum,hit->GetSiPMnum(),hitTime,energy});
+
+  hit->photonCount(weight);
+
+  hit->CountWavlenSpectrum(fBinning.findWavBin(energy),weight);
+  hit->CountTimeStruct(fBinning.findTimeBin(hitTime),weight);
 }
 
 void DRsimSiPMSD::EndOfEvent(G4HCofThisEvent*) {
+  if (sRecord) sRecord->flush();
+
   if ( verboseLevel>1 ) {
     G4int nofHits = fHitCollection->entries();
     G4cout
@@ -88,33 +141,113 @@ void DRsimSiPMSD::EndOfEvent(G4HCofThisEvent*) {
   }
 }
 
-DRsimInterface::hitRange DRsimSiPMSD::findWavRange(G4double en) {
-  int i = 0;
-  for ( ; i < fWavBin+1; i++) {
-    if ( en < wavToE( (fWavlenStart - (float)i*fWavlenStep)*nm ) ) break;
-  }
+DRsimInterface::hitXY DRsimSiPMSD::findSiPMXY(G4int SiPMnum, DRsimInterface::hitXY towerXY) {
+  int x = SiPMnum/towerXY.second;
+  int y = SiPMnum%towerXY.second;
 
-  if (i==0) return std::make_pair(fWavlenStart,99999.);
-  else if (i==fWavBin+1) return std::make_pair(0.,fWavlenEnd);
+  return std::make_pair(x,y);
+}
 
-  return std::make_pair( fWavlenStart-(float)i*fWavlenStep, fWavlenStart-(float)(i-1)*fWavlenStep );
+void DRsimSiPMSD::record(const DRsimSiPMRecord& rec) {
+  if (!sRecord) {
+    G4String filename = sRecordPath+"_t"+std::to_string(std::max(G4Threading::G4GetThreadId(),0))+".bin";
+    sRecord = new std::ofstream(filename, std::ios::binary);
+  }
+
+  sRecord->write(reinterpret_cast<const char*>(&rec),sizeof(rec));
 }
 
-DRsimInterface::hitRange DRsimSiPMSD::findTimeRange(G4double stepTime) {
-  int i = 0;
-  for ( ; i < fTimeBin+1; i++) {
-    if ( stepTime < ( (fTimeStart + (float)i*fTimeStep)*ns ) ) break;
+void DRsimSiPMSD::Benchmark(const G4String& filename) {
+  std::vector<DRsimSiPMRecord> records;
+  {
+    std::ifstream in(filename, std::ios::binary);
+    DRsimSiPMRecord rec;
+    while ( in.read(reinterpret_cast<char*>(&rec),sizeof(rec)) ) records.push_back(rec);
   }
 
-  if (i==0) return std::make_pair(0.,fTimeStart);
-  else if (i==fTimeBin+1) return std::make_pair(fTimeEnd,99999.);
+  G4int nModule = 0, nSiPM = 0;
+  G4double nPhoton = 0.;
+  for (const auto& rec : records) {
+    if ( rec.module < 0 ) continue;
+    nModule = std::max(nModule,rec.module+1);
+    nSiPM = std::max(nSiPM,rec.SiPMnum+1);
+    if ( rec.SiPMnum >= 0 ) nPhoton++;
+  }
 
-  return std::make_pair( fTimeStart+(float)(i-1)*fTimeStep, fTimeStart+(float)i*fTimeStep );
-}
+  if ( nPhoton==0. ) {
+    G4ExceptionDescription msg;
+    msg << "no recorded photons in " << filename;
+    G4Exception("DRsimSiPMSD::Benchmark()", "DRsimCode013", JustWarning, msg);
+    return;
+  }
 
-DRsimInterface::hitXY DRsimSiPMSD::findSiPMXY(G4int SiPMnum, DRsimInterface::hitXY towerXY) {
-  int x = SiPMnum/towerXY.second;
-  int y = SiPMnum%towerXY.second;
+  // the replay itself must not be recorded
+  G4String recordPath = sRecordPath;
+  sRecordPath = "";
 
-  return std::make_pair(x,y);
+  DRsimInterface::DRsimModuleProperty prop;
+  prop.towerXY = std::make_pair(1,nSiPM);
+
+  const char* names[2] = {"linear scan","dense index"};
+  G4double time[2] = {0.,0.};
+  G4long count[2] = {0,0};
+  G4Timer timer;
+
+  for (int mode = 0; mode < 2; mode++) {
+    std::vector<DRsimSiPMSD*> sds;
+    for (int i = 0; i < nModule; i++) {
+      prop.ModuleNum = i;
+      sds.push_back(new DRsimSiPMSD("SiPMBench"+std::to_string(i),"SiPMBenchColl"+std::to_string(i),prop));
+      sds.back()->resetHits();
+    }
+
+    auto clearHits = [&count,mode] (DRsimSiPMSD* sd) {
+      for (size_t i = 0; i < sd->fHitCollection->entries(); i++) count[mode] += (*sd->fHitCollection)[i]->GetPhotonCount();
+      delete sd->fHitCollection;
+    };
+
+    // whole loop is timed, a single photon is below the G4Timer resolution
+    timer.Start();
+    for (const auto& rec : records) {
+      if ( rec.module < 0 ) continue;
+      DRsimSiPMSD* sd = sds[rec.module];
+
+      if ( rec.SiPMnum < 0 ) {
+        clearHits(sd);
+        sd->resetHits();
+        continue;
+      }
+
+      DRsimSiPMHit* hit = NULL;
+      if ( mode==0 ) {
+        // lookup of ProcessHits before the dense index
+        for (size_t i = 0; i < sd->fHitCollection->entries(); i++) {
+          if ( (*sd->fHitCollection)[i]->GetSiPMnum()==rec.SiPMnum && (*sd->fHitCollection)[i]->GetModuleNum()==sd->fModuleNum ) {
+            hit = (*sd->fHitCollection)[i];
+            break;
+          }
+        }
+      } else {
+        hit = sd->fHitIndex[rec.SiPMnum];
+      }
+      if (hit==NULL) hit = sd->createHit(rec.SiPMnum,G4ThreeVector());
+
+      sd->countPhoton(hit,rec.energy,rec.time,1);
+    }
+    timer.Stop();
+    time[mode] = timer.GetRealElapsed();
+
+    for (auto sd : sds) {
+      clearHits(sd);
+      delete sd;
+    }
+  }
+
+  sRecordPath = recordPath;
+
+  G4cout << "DRsimSiPMSD: " << records.size() << " records, " << nPhoton << " photons, " << nModule << " modules, " << nSiPM << " SiPMs/module" << G4endl;
+  for (int mode = 0; mode < 2; mode++)
+    G4cout << "DRsimSiPMSD: " << names[mode] << " " << time[mode]/nPhoton*1.e9 << " ns/photon, " << count[mode] << " photons counted" << G4endl;
+
+  if ( count[0]!=count[1] ) G4Exception("DRsimSiPMSD::Benchmark()", "DRsimCode013", JustWarning, "linear scan and dense index counted different photon numbers");
 }
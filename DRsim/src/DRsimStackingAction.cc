@@ -0,0 +1,33 @@
+#include "DRsimStackingAction.hh"
+#include "DRsimDetectorConstruction.hh"
+
+#include "G4Track.hh"
+#include "G4OpticalPhoton.hh"
+#include "Randomize.hh"
+
+G4int DRsimStackingAction::sPhotonPrescale = 1;
+G4bool DRsimStackingAction::sEarlyKill = false;
+
+DRsimStackingAction::DRsimStackingAction(DRsimEventAction* eventAction)
+: G4UserStackingAction(), fEventAction(eventAction)
+{}
+
+G4ClassificationOfNewTrack DRsimStackingAction::ClassifyNewTrack(const G4Track* track) {
+  if ( track->GetDefinition() != G4OpticalPhoton::OpticalPhotonDefinition() ) return fUrgent;
+
+  DRsimPhotonCounts& counts = fEventAction->GetPhotonCounts();
+
+  if ( sPhotonPrescale > 1 && G4UniformRand()*sPhotonPrescale >= 1. ) {
+    counts.killedPrescale++;
+    return fKill;
+  }
+
+  if ( sEarlyKill && !DRsimDetectorConstruction::fHasReflector && track->GetMomentumDirection().z() <= 0. ) {
+    counts.killedBackward++;
+    return fKill;
+  }
+
+  counts.tracked++;
+
+  return fUrgent;
+}
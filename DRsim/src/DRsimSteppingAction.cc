@@ -5,11 +5,16 @@
 
 DRsimSteppingAction::DRsimSteppingAction(DRsimEventAction* eventAction)
 : G4UserSteppingAction(), fEventAction(eventAction)
-{}
+{
+  fVacuum = G4Material::GetMaterial("G4_Galactic",false);
+  fAir = G4Material::GetMaterial("Air",false);
+}
 
 DRsimSteppingAction::~DRsimSteppingAction() {}
 
 void DRsimSteppingAction::UserSteppingAction(const G4Step* step) {
+  if (DRsimEventAction::sPhotonStats) fEventAction->countStep();
+
   if (step->GetTrack()->GetDefinition() == G4OpticalPhoton::OpticalPhotonDefinition()) return;
 
   G4Track* track = step->GetTrack();
@@ -35,12 +40,12 @@ void DRsimSteppingAction::UserSteppingAction(const G4Step* step) {
     fEventAction->fillLeaks(fLeak);
   }
 
-  G4String matName = preVol->GetMaterial()->GetName();
+  const G4Material* mat = preVol->GetMaterial();
 
-  if ( matName=="G4_Galactic" || matName=="Air" ) return;
+  if ( mat==fVacuum || mat==fAir ) return;
 
-  G4VPhysicalVolume* motherTower = GetMotherTower(theTouchable);
-  fEdep.ModuleNum = GetModuleNum(motherTower->GetName());
+  fEdep.ModuleNum = GetModuleNum(theTouchable);
+  if ( fEdep.ModuleNum < 0 ) return;
 
   G4double pdgCharge = particle->GetPDGCharge();
 
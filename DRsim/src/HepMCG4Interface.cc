@@ -29,33 +29,88 @@ G4bool HepMCG4Interface::CheckVertexInsideWorld(const G4ThreeVector& pos) const
 }
 
 void HepMCG4Interface::HepMC2G4(const HepMC3::GenEvent* hepmcevt, G4Event* g4event) {
-  for( auto vitr = hepmcevt->vertices().begin(); vitr != hepmcevt->vertices().end(); ++vitr ) { // loop for vertex ...
+  // once per event; not kept across events as the geometry can be rebuilt between runs
+  G4Navigator* navigator = G4TransportationManager::GetTransportationManager()->GetNavigatorForTracking();
+
+  std::vector<HepMCG4Vertex> vertices;
+  HepMC2Vertices(hepmcevt,navigator->GetWorldVolume()->GetLogicalVolume()->GetSolid(),vertices);
+  Vertices2G4(vertices,g4event);
+}
+
+void HepMCG4Interface::HepMC2Vertices(const HepMC3::GenEvent* hepmcevt, const G4VSolid* world, std::vector<HepMCG4Vertex>& vertices) {
+  vertices.clear();
+
+  static G4ThreadLocal HepMCG4VertexLookup* lookup = 0;
+  if (!lookup) lookup = new HepMCG4VertexLookup();
+  lookup->clear();
+
+  for (const auto& vertex : hepmcevt->vertices()) {
     // real vertex?
-    G4bool qvtx=false;
-    for (auto pitr = (*vitr)->particles_out().begin(); pitr != (*vitr)->particles_out().end(); ++pitr) {
-      if (!(*pitr)->end_vertex() && (*pitr)->status()==1) {
-        qvtx=true;
+    G4bool qvtx = false;
+    for (const auto& ptc : vertex->particles_out()) {
+      if (!ptc->end_vertex() && ptc->status()==1) {
+        qvtx = true;
         break;
       }
     }
     if (!qvtx) continue;
 
-    // check world boundary
-    HepMC3::FourVector pos = (*vitr)->position();
-    G4LorentzVector xvtx(pos.x(), pos.y(), pos.z(), pos.t());
-    if (!CheckVertexInsideWorld(xvtx.vect()*mm)) continue;
+    G4int idx = FindVertex(vertex->position(),world,vertices,*lookup);
+    if ( idx == kOutsideWorld ) continue;
 
-    // create G4PrimaryVertex and associated G4PrimaryParticles
-    G4PrimaryVertex* g4vtx = new G4PrimaryVertex(xvtx.x()*mm, xvtx.y()*mm, xvtx.z()*mm, xvtx.t()*mm/c_light);
+    for (const auto& ptc : vertex->particles_out()) {
+      if ( ptc->status() != 1 ) continue;
+
+      const HepMC3::FourVector& mom = ptc->momentum();
+      HepMCG4Particle g4ptc;
+      g4ptc.pdgId = ptc->pdg_id();
+      g4ptc.px = mom.px()*GeV;
+      g4ptc.py = mom.py()*GeV;
+      g4ptc.pz = mom.pz()*GeV;
+      vertices[idx].particles.push_back(g4ptc);
+    }
+  }
+}
 
-    for (auto vpitr = (*vitr)->particles_out().begin(); vpitr != (*vitr)->particles_out().end(); ++vpitr) {
-      if( (*vpitr)->status() != 1 ) continue;
+size_t HepMCG4VertexKeyHash::operator()(const HepMCG4VertexKey& key) const {
+  std::hash<G4double> hash;
+  size_t seed = 0;
 
-      G4int pdgcode = (*vpitr)->pdg_id();
-      pos = (*vpitr)->momentum();
-      G4LorentzVector p(pos.px(), pos.py(), pos.pz(), pos.e());
-      G4PrimaryParticle* g4prim = new G4PrimaryParticle(pdgcode, p.x()*GeV, p.y()*GeV, p.z()*GeV);
+  // +0. folds -0. into 0., which compare equal
+  for (G4double val : {key.x, key.y, key.z, key.t})
+    seed ^= hash(val+0.) + 0x9e3779b9 + (seed<<6) + (seed>>2);
+
+  return seed;
+}
+
+G4int HepMCG4Interface::FindVertex(const HepMC3::FourVector& pos, const G4VSolid* world, std::vector<HepMCG4Vertex>& vertices, HepMCG4VertexLookup& lookup) {
+  G4ThreeVector xvtx(pos.x()*mm, pos.y()*mm, pos.z()*mm);
+  if (world && world->Inside(xvtx) != kInside) return kOutsideWorld;
+
+  // co-located HepMC vertices (e.g. everything at the origin) share one G4PrimaryVertex
+  HepMCG4VertexKey key = {xvtx.x(), xvtx.y(), xvtx.z(), pos.t()*mm/c_light};
+  auto found = lookup.emplace(key,(G4int)vertices.size());
+  if (!found.second) return found.first->second;
+
+  vertices.emplace_back();
+  HepMCG4Vertex& vtx = vertices.back();
+  vtx.x = key.x;
+  vtx.y = key.y;
+  vtx.z = key.z;
+  vtx.t = key.t;
+
+  return vertices.size()-1;
+}
+
+void HepMCG4Interface::Vertices2G4(const std::vector<HepMCG4Vertex>& vertices, G4Event* g4event, const G4VSolid* world) {
+  for (const auto& vtx : vertices) {
+    if (world && world->Inside(G4ThreeVector(vtx.x,vtx.y,vtx.z)) != kInside) continue;
+
+    // create G4PrimaryVertex and associated G4PrimaryParticles
+    G4PrimaryVertex* g4vtx = new G4PrimaryVertex(vtx.x, vtx.y, vtx.z, vtx.t);
 
+    for (const auto& ptc : vtx.particles) {
+      G4PrimaryParticle* g4prim = new G4PrimaryParticle(ptc.pdgId, ptc.px, ptc.py, ptc.pz);
       g4vtx->SetPrimary(g4prim);
     }
     g4event->AddPrimaryVertex(g4vtx);
@@ -0,0 +1,73 @@
+#include "HepMCG4Prefetcher.hh"
+
+#include "HepMC3/Units.h"
+#include "HepMC3/Print.h"
+
+#include <algorithm>
+
+HepMCG4Prefetcher::HepMCG4Prefetcher(const G4String& path, G4int queueSize, G4int verbose)
+: fQueueSize(std::max(queueSize,1)), fVerbose(verbose), fNextIdx(0), fEnd(false), fStop(false)
+{
+  // the reader thread does ROOT I/O next to the output writer, see ROOT::EnableThreadSafety in main()
+  fReader = new HepMC3::ReaderRootTree(path.c_str());
+  fThread = std::thread(&HepMCG4Prefetcher::run,this);
+}
+
+HepMCG4Prefetcher::~HepMCG4Prefetcher() {
+  {
+    G4AutoLock lock(&fMutex);
+    fStop = true;
+  }
+  fReaderCV.notify_one();
+
+  if (fThread.joinable()) fThread.join();
+
+  fReader->close();
+  delete fReader;
+}
+
+G4bool HepMCG4Prefetcher::pop(HepMCG4Record& record) {
+  G4AutoLock lock(&fMutex);
+
+  fConsumerCV.wait(lock, [this] { return !fQueue.empty() || fEnd; });
+  if (fQueue.empty()) return false;
+
+  record = std::move(fQueue.front());
+  fQueue.pop_front();
+  fReaderCV.notify_one();
+
+  return true;
+}
+
+void HepMCG4Prefetcher::run() {
+  HepMC3::GenEvent evt(HepMC3::Units::GEV,HepMC3::Units::MM);
+
+  while (true) {
+    {
+      G4AutoLock lock(&fMutex);
+      fReaderCV.wait(lock, [this] { return fStop || (G4int)fQueue.size() < fQueueSize; });
+      if (fStop) return;
+    }
+
+    // read and decode without holding the lock
+    HepMCG4Record record;
+    G4bool failed = !fReader->read_event(evt) || fReader->failed();
+
+    if (!failed) {
+      if ( fVerbose>0 ) HepMC3::Print::listing(evt);
+      record.idx = fNextIdx++;
+      // no world check here, the geometry can change while the prefetcher lives on
+      HepMCG4Interface::HepMC2Vertices(&evt,0,record.vertices);
+    }
+
+    G4AutoLock lock(&fMutex);
+    if (failed) {
+      fEnd = true;
+      fConsumerCV.notify_all();
+      return;
+    }
+
+    fQueue.push_back(std::move(record));
+    fConsumerCV.notify_one();
+  }
+}
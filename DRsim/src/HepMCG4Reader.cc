@@ -1,40 +1,338 @@
 #include "HepMCG4Reader.hh"
 #include "G4GenericMessenger.hh"
+#include "G4RunManager.hh"
+#include "G4TransportationManager.hh"
+#include "G4Timer.hh"
+#include "G4PhysicalConstants.hh"
+#include "G4SystemOfUnits.hh"
 
 #include <iostream>
 #include <fstream>
+#include <atomic>
+#include <thread>
+#include <tuple>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+  const G4VSolid* worldSolid() {
+    return G4TransportationManager::GetTransportationManager()->GetNavigatorForTracking()->GetWorldVolume()->GetLogicalVolume()->GetSolid();
+  }
+
+  // the original HepMC2G4, one G4 vertex per HepMC vertex; reference for BenchmarkConversion
+  void HepMC2VerticesUnmerged(const HepMC3::GenEvent* hepmcevt, const G4VSolid* world, std::vector<HepMCG4Vertex>& vertices) {
+    vertices.clear();
+
+    for (const auto& vertex : hepmcevt->vertices()) {
+      G4bool qvtx = false;
+      for (const auto& ptc : vertex->particles_out()) {
+        if (!ptc->end_vertex() && ptc->status()==1) {
+          qvtx = true;
+          break;
+        }
+      }
+      if (!qvtx) continue;
+
+      const HepMC3::FourVector& pos = vertex->position();
+      G4ThreeVector xvtx(pos.x()*mm, pos.y()*mm, pos.z()*mm);
+      if (world->Inside(xvtx) != kInside) continue;
+
+      vertices.emplace_back();
+      HepMCG4Vertex& vtx = vertices.back();
+      vtx.x = xvtx.x();
+      vtx.y = xvtx.y();
+      vtx.z = xvtx.z();
+      vtx.t = pos.t()*mm/c_light;
+
+      for (const auto& ptc : vertex->particles_out()) {
+        if (ptc->status() != 1) continue;
+
+        HepMCG4Particle g4ptc;
+        g4ptc.pdgId = ptc->pdg_id();
+        g4ptc.px = ptc->momentum().px()*GeV;
+        g4ptc.py = ptc->momentum().py()*GeV;
+        g4ptc.pz = ptc->momentum().pz()*GeV;
+        vtx.particles.push_back(g4ptc);
+      }
+    }
+  }
+
+  G4int countParticles(const std::vector<HepMCG4Vertex>& vertices) {
+    G4int n = 0;
+    for (const auto& vtx : vertices) n += vtx.particles.size();
+    return n;
+  }
+}
 
 HepMCG4Reader::HepMCG4Reader(G4int seed, G4String hepMCpath)
-: verbose(1), fMessenger(0), fSeed(seed), fHepMCpath(hepMCpath)
+: verbose(0), fMessenger(0), fSeed(seed), fHepMCpath(hepMCpath), fQueueSize(64), fPrefetcher(0),
+  fSubEvents(1)
 {
   DefineCommands();
   Initialize();
 }
 
 HepMCG4Reader::~HepMCG4Reader() {
-  reader->close();
-  delete reader;
+  delete fPrefetcher;
   delete fMessenger;
 }
 
 void HepMCG4Reader::Initialize() {
   fHepMCpath += "_"+std::to_string(fSeed)+".root";
-  reader = new HepMC3::ReaderRootTree(fHepMCpath.c_str());
 }
 
-HepMC3::GenEvent* HepMCG4Reader::GenerateHepMCEvent() {
-  HepMC3::GenEvent* evt = new HepMC3::GenEvent(HepMC3::Units::GEV,HepMC3::Units::MM);
-  reader->read_event(*evt);
-  if( reader->failed() ) return 0;
-  if( verbose>0 ) HepMC3::Print::listing(*evt);;
+G4int HepMCG4Reader::GenerateEvent(G4Event* anEvent, G4int& subEvt, G4int& nSubEvt) {
+  std::shared_ptr<SplitEvent> split;
+  size_t part = 0;
+
+  {
+    G4AutoLock lock(&fMutex);
+    if (!fPrefetcher) fPrefetcher = new HepMCG4Prefetcher(fHepMCpath,fQueueSize,verbose);
+
+    // only the claim is locked, the pop and the conversion below run in parallel; claiming the
+    // slot of a new event here keeps exactly fSubEvents G4 events per HepMC event
+    if (fSubEvents > 1) {
+      if (!fOpen) fOpen = std::make_shared<SplitEvent>(SplitEvent{-1,0,false,{}});
+
+      split = fOpen;
+      part = split->nextPart++;
+      if (split->nextPart >= (size_t)fSubEvents) fOpen.reset();
+    }
+  }
+
+  HepMCG4Record record;
+  G4bool popped = true;
+
+  if (!split || part==0) {
+    popped = fPrefetcher->pop(record);
+
+    if (split) {
+      if (popped) SplitVertices(record.vertices,fSubEvents,split->parts);
+
+      G4AutoLock lock(&fMutex);
+      split->idx = popped ? record.idx : -1;
+      split->ready = true;
+      fReadyCV.notify_all();
+    }
+  } else {
+    G4AutoLock lock(&fMutex);
+    fReadyCV.wait(lock, [&split] { return split->ready; });
+    popped = split->idx >= 0;
+  }
+
+  if (!popped) {
+    G4cout << "HepMCInterface: no generated particles. run terminated..." << G4endl;
+    // AbortRun only flags the current event when called while tracking, not from here
+    anEvent->SetEventAborted();
+    G4RunManager::GetRunManager()->AbortRun();
+    subEvt = 0;
+    nSubEvt = 1;
+    return -1;
+  }
+
+  if (!split) {
+    Vertices2G4(record.vertices,anEvent,worldSolid()); // the current geometry, it can be rebuilt between runs
+    subEvt = 0;
+    nSubEvt = 1;
+
+    return record.idx;
+  }
+
+  subEvt = part;
+  nSubEvt = fSubEvents;
+  Vertices2G4(split->parts.at(part),anEvent,worldSolid());
+
+  return split->idx;
+}
+
+void HepMCG4Reader::EndOfRun() {
+  G4AutoLock lock(&fMutex);
+
+  // the writer of this run has already dropped the parts it got; the rest must not leak into the next run
+  if (fOpen && fOpen->idx >= 0) {
+    G4ExceptionDescription msg;
+    msg << "HepMC event " << fOpen->idx << " dropped, only " << fOpen->nextPart << " of its " << fSubEvents << " sub-events were simulated" << G4endl;
+    G4Exception("HepMCG4Reader::EndOfRun()", "DRsimCode012", JustWarning, msg);
+  }
+
+  fOpen.reset();
+}
+
+void HepMCG4Reader::SplitVertices(const std::vector<HepMCG4Vertex>& vertices, G4int nPart, std::vector<std::vector<HepMCG4Vertex>>& parts) {
+  // (momentum, vertex, particle), heaviest first
+  std::vector<std::tuple<G4double,size_t,size_t>> ptcs;
+  for (size_t iVtx = 0; iVtx < vertices.size(); iVtx++) {
+    for (size_t iPtc = 0; iPtc < vertices[iVtx].particles.size(); iPtc++) {
+      const HepMCG4Particle& ptc = vertices[iVtx].particles[iPtc];
+      ptcs.emplace_back(std::sqrt(ptc.px*ptc.px+ptc.py*ptc.py+ptc.pz*ptc.pz),iVtx,iPtc);
+    }
+  }
+  std::sort(ptcs.begin(), ptcs.end(), [] (const std::tuple<G4double,size_t,size_t>& a, const std::tuple<G4double,size_t,size_t>& b) { return a > b; });
 
-  return evt;
+  parts.assign(nPart,std::vector<HepMCG4Vertex>());
+  std::vector<G4double> load(nPart,0.);
+  std::vector<std::vector<G4int>> vtxIdx(nPart,std::vector<G4int>(vertices.size(),-1)); // vertex position in each part
+
+  for (const auto& ptc : ptcs) {
+    G4int iPart = std::min_element(load.begin(),load.end()) - load.begin();
+    load[iPart] += std::get<0>(ptc);
+
+    const HepMCG4Vertex& vtx = vertices[std::get<1>(ptc)];
+    G4int& idx = vtxIdx[iPart][std::get<1>(ptc)];
+    if (idx < 0) {
+      idx = parts[iPart].size();
+      parts[iPart].push_back(HepMCG4Vertex{vtx.x,vtx.y,vtx.z,vtx.t,{}});
+    }
+
+    parts[iPart][idx].particles.push_back(vtx.particles[std::get<2>(ptc)]);
+  }
+}
+
+void HepMCG4Reader::Benchmark(G4int nEvent) {
+  if (!G4TransportationManager::GetTransportationManager()->GetNavigatorForTracking()->GetWorldVolume()) {
+    G4Exception("HepMCG4Reader::Benchmark()", "DRsimCode009", JustWarning, "geometry not constructed, run /run/initialize first");
+    return;
+  }
+
+  const G4VSolid* world = worldSolid();
+  G4int maxThreads = std::max(1u,std::thread::hardware_concurrency());
+
+  for (G4int nThread = 1; nThread <= maxThreads; nThread *= 2) {
+    G4Timer timer;
+
+    // what the workers did before: one reader, read and decode under a lock
+    {
+      HepMC3::ReaderRootTree reader(fHepMCpath.c_str());
+      G4Mutex mutex;
+      G4int nRead = 0;
+      std::vector<std::thread> consumers;
+
+      timer.Start();
+      for (G4int i = 0; i < nThread; i++) {
+        consumers.emplace_back([&] {
+          HepMC3::GenEvent evt(HepMC3::Units::GEV,HepMC3::Units::MM);
+          std::vector<HepMCG4Vertex> vertices;
+          while (true) {
+            G4AutoLock lock(&mutex);
+            if ( nRead >= nEvent || !reader.read_event(evt) || reader.failed() ) return;
+            nRead++;
+            HepMC2Vertices(&evt,world,vertices);
+          }
+        });
+      }
+      for (auto& consumer : consumers) consumer.join();
+      timer.Stop();
+      reader.close();
+
+      G4cout << "HepMCG4Reader: " << nThread << " thread(s), locked reader " << nRead/timer.GetRealElapsed() << " events/s" << G4endl;
+    }
+
+    {
+      HepMCG4Prefetcher prefetcher(fHepMCpath,fQueueSize,0);
+      std::atomic<G4int> nRead(0);
+      std::vector<std::thread> consumers;
+
+      timer.Start();
+      for (G4int i = 0; i < nThread; i++) {
+        consumers.emplace_back([&] {
+          HepMCG4Record record;
+          while ( nRead < nEvent && prefetcher.pop(record) ) nRead++;
+        });
+      }
+      for (auto& consumer : consumers) consumer.join();
+      timer.Stop();
+
+      G4cout << "HepMCG4Reader: " << nThread << " thread(s), prefetcher " << nRead/timer.GetRealElapsed() << " events/s" << G4endl;
+    }
+  }
+}
+
+void HepMCG4Reader::BenchmarkConversion(G4int nEvent) {
+  if (!G4TransportationManager::GetTransportationManager()->GetNavigatorForTracking()->GetWorldVolume()) {
+    G4Exception("HepMCG4Reader::BenchmarkConversion()", "DRsimCode009", JustWarning, "geometry not constructed, run /run/initialize first");
+    return;
+  }
+
+  const G4VSolid* world = worldSolid();
+
+  // decode once, only the conversion is timed
+  std::vector<HepMC3::GenEvent> events;
+  events.reserve(nEvent);
+  {
+    HepMC3::ReaderRootTree reader(fHepMCpath.c_str());
+    while ( (G4int)events.size() < nEvent ) {
+      events.emplace_back(HepMC3::Units::GEV,HepMC3::Units::MM);
+      if ( !reader.read_event(events.back()) || reader.failed() ) {
+        events.pop_back();
+        break;
+      }
+    }
+    reader.close();
+  }
+  if (events.empty()) return;
+
+  std::vector<HepMCG4Vertex> vertices;
+  std::vector<G4int> nPtc;
+  G4double nHepMCVtx = 0., nVtx[2] = {0.,0.}, time[2] = {0.,0.};
+  G4int mismatch = 0;
+  G4Timer timer;
+
+  // whole loops are timed, a single event is below the G4Timer resolution
+  timer.Start();
+  for (const auto& evt : events) {
+    HepMC2VerticesUnmerged(&evt,world,vertices);
+    nVtx[0] += vertices.size();
+    nPtc.push_back(countParticles(vertices));
+  }
+  timer.Stop();
+  time[0] = timer.GetRealElapsed();
+
+  timer.Start();
+  for (unsigned i = 0; i < events.size(); i++) {
+    HepMC2Vertices(&events[i],world,vertices);
+    nVtx[1] += vertices.size();
+    if ( countParticles(vertices) != nPtc[i] ) mismatch++;
+  }
+  timer.Stop();
+  time[1] = timer.GetRealElapsed();
+
+  for (const auto& evt : events) nHepMCVtx += evt.vertices().size();
+
+  G4double n = events.size();
+  G4cout << "HepMCG4Reader: " << events.size() << " events, " << nHepMCVtx/n << " HepMC vertices/event" << G4endl;
+  G4cout << "HepMCG4Reader: unmerged " << time[0]/n*1.e6 << " us/event, " << nVtx[0]/n << " G4 vertices/event" << G4endl;
+  G4cout << "HepMCG4Reader: merged " << time[1]/n*1.e6 << " us/event, " << nVtx[1]/n << " G4 vertices/event, "
+         << mismatch << " events with a different particle count" << G4endl;
 }
 
 void HepMCG4Reader::DefineCommands() {
   fMessenger = new G4GenericMessenger(this, "/DRsim/hepMC/", "HepMC IO control");
 
-  G4GenericMessenger::Command& verboseCmd = fMessenger->DeclareMethod("verbose",&HepMCG4Reader::SetVerboseLevel,"verbose level");
+  G4GenericMessenger::Command& verboseCmd = fMessenger->DeclareMethod("verbose",&HepMCG4Reader::SetVerboseLevel,"verbose level, 1 lists every event");
   verboseCmd.SetParameterName("verbose",true);
-  verboseCmd.SetDefaultValue("1");
+  verboseCmd.SetDefaultValue("0");
+
+  G4GenericMessenger::Command& queueCmd = fMessenger->DeclareProperty("queueSize",fQueueSize,"max. number of events decoded ahead, set before the first event");
+  queueCmd.SetParameterName("queueSize",true);
+  queueCmd.SetDefaultValue("64");
+
+  G4GenericMessenger::Command& subEvtCmd = fMessenger->DeclareProperty("subEvents",fSubEvents,"split each HepMC event into N G4 events tracked on different workers and merged before writing, set before the first event");
+  subEvtCmd.SetParameterName("subEvents",true);
+  subEvtCmd.SetRange("subEvents>=1");
+  subEvtCmd.SetDefaultValue("1");
+
+  G4GenericMessenger::Command& benchCmd = fMessenger->DeclareMethod("benchmark",&HepMCG4Reader::Benchmark,"read N events of the input with 1, 2, 4, ... threads, locked reader vs prefetcher");
+  benchCmd.SetParameterName("nEvent",true);
+  benchCmd.SetDefaultValue("1000");
+
+  G4GenericMessenger::Command& convCmd = fMessenger->DeclareMethod("benchmarkConversion",&HepMCG4Reader::BenchmarkConversion,"time the HepMC to G4 vertex conversion of N events of the input, one G4 vertex per HepMC vertex vs co-located ones merged");
+  convCmd.SetParameterName("nEvent",true);
+  convCmd.SetDefaultValue("1000");
+
+  // the reader is shared, workers must not replay these
+  verboseCmd.command->SetToBeBroadcasted(false);
+  queueCmd.command->SetToBeBroadcasted(false);
+  subEvtCmd.command->SetToBeBroadcasted(false);
+  benchCmd.command->SetToBeBroadcasted(false);
+  convCmd.command->SetToBeBroadcasted(false);
 }
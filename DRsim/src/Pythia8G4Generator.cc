@@ -0,0 +1,166 @@
+#include "Pythia8G4Generator.hh"
+
+#include "Pythia8/Pythia.h"
+#include "HepMC3/GenEvent.h"
+#include "HepMC3/WriterRootTree.h"
+#include "Pythia8ToHepMC3.h"
+#include "P8filter.h"
+#include "P8ptcgun.h"
+
+#include "G4RunManager.hh"
+#include "G4TransportationManager.hh"
+#include "G4Threading.hh"
+#include "G4AutoLock.hh"
+#include "G4SystemOfUnits.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+
+namespace { G4Mutex Pythia8G4GeneratorMutex = G4MUTEX_INITIALIZER; }
+G4String Pythia8G4Generator::sMode = "ptcgun";
+G4String Pythia8G4Generator::sCmndFile = "ptcgun.cmnd";
+G4String Pythia8G4Generator::sHepMCPath = "";
+
+Pythia8G4Generator::Pythia8G4Generator(G4int seed)
+: G4VPrimaryGenerator(), fFilter(0), fPtcgun(0), fToHepMC(0), fWriter(0)
+{
+  G4int threadId = std::max(G4Threading::G4GetThreadId(),0);
+  // Pythia takes seeds up to 900000000, 0 would mean its default seed;
+  // only used for the initialization, every event is reseeded in GenerateEvent
+  G4int threadSeed = ( (long)std::max(seed,0)*1000 + threadId ) % 900000000 + 1;
+
+  fPythia = new Pythia8::Pythia();
+  if ( !fPythia->readFile(sCmndFile) ) {
+    G4ExceptionDescription msg;
+    msg << "cannot read Pythia8 settings " << sCmndFile;
+    G4Exception("Pythia8G4Generator::Pythia8G4Generator()", "DRsimCode010", FatalException, msg);
+  }
+  fPythia->readString("Random:setSeed = on");
+  fPythia->readString("Random:seed = "+std::to_string(threadSeed));
+
+  fNAbort = fPythia->mode("Main:timesAllowErrors");
+  fUseGun = ( sMode == "ptcgun" );
+
+  // same meaning of the spare settings as in P8ptcgen and P8generic
+  if (fUseGun) {
+    fAtRest = fPythia->flag("Main:spareFlag1");
+    fColSinglet = fPythia->flag("Main:spareFlag2");
+    fScale = fPythia->parm("Main:spareParm3");
+    fPtcgun = new P8ptcgun(fPythia->mode("Main:spareMode1"), fPythia->parm("Main:spareParm1"), fPythia->parm("Main:spareParm2"), 0.);
+  } else {
+    fFilter = new P8filter(fPythia->flag("Main:spareFlag1"), fPythia->parm("Main:spareParm1"), fPythia->parm("Main:spareParm2"));
+  }
+
+  fPythia->init();
+
+  if ( !sHepMCPath.empty() ) {
+    G4AutoLock lock(&Pythia8G4GeneratorMutex); // TFile creation touches ROOT's global lists
+
+    fToHepMC = new HepMC3::Pythia8ToHepMC3();
+    fWriter = new HepMC3::WriterRootTree(sHepMCPath+"_t"+std::to_string(threadId)+"_"+std::to_string(seed)+".root");
+  }
+}
+
+Pythia8G4Generator::~Pythia8G4Generator() {
+  if (fWriter) {
+    fWriter->close();
+    delete fWriter;
+  }
+
+  fPythia->stat();
+
+  delete fToHepMC;
+  delete fFilter;
+  delete fPtcgun;
+  delete fPythia;
+}
+
+G4bool Pythia8G4Generator::next() {
+  G4int iAbort = 0;
+
+  while (true) {
+    if (fUseGun) {
+      if (fColSinglet) fPtcgun->fillResonance( fPythia->event, fPythia->particleData, fPythia->rndm, fAtRest );
+      else {
+        fPtcgun->fillParton( fPythia->event, fPythia->particleData, fPythia->rndm, fAtRest, fScale );
+        fPythia->forceTimeShower( 1, 2, fScale );
+      }
+    }
+
+    if (!fPythia->next()) {
+      if (fPythia->info.atEndOfFile() || ++iAbort >= fNAbort) return false;
+      continue;
+    }
+
+    if ( !fUseGun && !fFilter->filter(fPythia->event, fPythia->info) ) continue;
+
+    // as P8generic and P8ptcgen, which hand FastJet the final state without neutrinos
+    if ( hasFinalState() ) return true;
+  }
+}
+
+G4bool Pythia8G4Generator::hasFinalState() const {
+  const Pythia8::Event& event = fPythia->event;
+
+  for (int i = 0; i < event.size(); ++i) {
+    if ( event[i].isFinal() && event[i].idAbs() != 12 && event[i].idAbs() != 14 && event[i].idAbs() != 16 ) return true;
+  }
+
+  G4cout << "Pythia8G4Generator: event with no final state particles, generating another one" << G4endl;
+
+  return false;
+}
+
+G4bool Pythia8G4Generator::GenerateEvent(G4Event* anEvent, G4int idx) {
+  // reseeded from the event's own G4 random stream, so the event is the same whichever thread runs it
+  fPythia->rndm.init( (G4int)(G4UniformRand()*899999999.) + 1 );
+
+  // a failed event is skipped, as P8generic does, and not written (the writer moves past it);
+  // only the end of an LHE input ends the run, the other workers reach it as well
+  if (!next()) {
+    anEvent->SetEventAborted();
+
+    if (fPythia->info.atEndOfFile()) {
+      G4cout << "Pythia8G4Generator: end of Les Houches Event File. run terminated..." << G4endl;
+      G4RunManager::GetRunManager()->AbortRun();
+    } else {
+      G4ExceptionDescription msg;
+      msg << "Pythia8 failed " << fNAbort << " times in a row, event " << idx << " skipped" << G4endl;
+      G4Exception("Pythia8G4Generator::GenerateEvent()", "DRsimCode010", JustWarning, msg);
+    }
+
+    return false;
+  }
+
+  Pythia2Vertices(G4TransportationManager::GetTransportationManager()->GetNavigatorForTracking()->GetWorldVolume()->GetLogicalVolume()->GetSolid());
+  HepMCG4Interface::Vertices2G4(fVertices,anEvent);
+
+  if (fWriter) {
+    HepMC3::GenEvent hepmcevt(HepMC3::Units::GEV, HepMC3::Units::MM);
+    fToHepMC->fill_next_event( *fPythia, &hepmcevt, idx );
+    fWriter->write_event(hepmcevt);
+  }
+
+  return true;
+}
+
+void Pythia8G4Generator::Pythia2Vertices(const G4VSolid* world) {
+  // final-state particles grouped by production vertex, as HepMC2G4 sees them
+  fVertices.clear();
+  fVertexLookup.clear();
+  const Pythia8::Event& event = fPythia->event;
+
+  for (int i = 0; i < event.size(); ++i) {
+    if (!event[i].isFinal()) continue;
+
+    G4int idx = HepMCG4Interface::FindVertex(HepMC3::FourVector(event[i].xProd(), event[i].yProd(), event[i].zProd(), event[i].tProd()), world, fVertices, fVertexLookup);
+    if ( idx == HepMCG4Interface::kOutsideWorld ) continue;
+
+    HepMCG4Particle ptc;
+    ptc.pdgId = event[i].id();
+    ptc.px = event[i].px()*GeV;
+    ptc.py = event[i].py()*GeV;
+    ptc.pz = event[i].pz()*GeV;
+    fVertices[idx].particles.push_back(ptc);
+  }
+}
@@ -20,6 +20,8 @@ dimensionCalc::dimensionCalc() {
   fPMTT         = 0;
   fReflectorT   = 0;
   fisModule     = false;
+  fModuleH      = 90.;
+  fModuleW      = 90.;
 
 }
 
@@ -30,7 +32,7 @@ G4ThreeVector dimensionCalc::GetOrigin(G4int i) {
   double row = i/fNofRow;
   double col = i%fNofRow;
 
-  return G4ThreeVector( -90 * (double)fNofRow/2. + row * 90 + 45, -90 * (double)fNofRow/2. + col * 90 + 45, ftower_height/2 + fFrontL);
+  return G4ThreeVector( -fModuleH * (double)fNofRow/2. + row * fModuleH + fModuleH/2., -fModuleW * (double)fNofRow/2. + col * fModuleW + fModuleW/2., ftower_height/2 + fFrontL);
 }
 
 G4ThreeVector dimensionCalc::GetOrigin_PMTG(G4int i) {
@@ -38,7 +40,7 @@ G4ThreeVector dimensionCalc::GetOrigin_PMTG(G4int i) {
   double row = i/fNofRow;
   double col = i%fNofRow;
 
-  return G4ThreeVector( -90 * (double)fNofRow/2. + row * 90 + 45, -90 * (double)fNofRow/2. + col * 90 + 45, ftower_height + fFrontL + fPMTT/2);
+  return G4ThreeVector( -fModuleH * (double)fNofRow/2. + row * fModuleH + fModuleH/2., -fModuleW * (double)fNofRow/2. + col * fModuleW + fModuleW/2., ftower_height + fFrontL + fPMTT/2);
 }
 
 G4ThreeVector dimensionCalc::GetOrigin_Reflector(G4int i) {
@@ -46,5 +48,5 @@ G4ThreeVector dimensionCalc::GetOrigin_Reflector(G4int i) {
   double row = i/fNofRow;
   double col = i%fNofRow;
 
-  return G4ThreeVector( -90 * (double)fNofRow/2. + row * 90 + 45, -90 * (double)fNofRow/2. + col * 90 + 45, fFrontL - fReflectorT/2);
+  return G4ThreeVector( -fModuleH * (double)fNofRow/2. + row * fModuleH + fModuleH/2., -fModuleW * (double)fNofRow/2. + col * fModuleW + fModuleW/2., fFrontL - fReflectorT/2);
 }
@@ -0,0 +1,30 @@
+#!/bin/sh
+# Runs the same particle gun and GPS jobs with 1 and 8 threads and compares the outputs by event_number.
+# The 8-thread job writes per-thread files, which also checks mergeDRsim.
+#
+#   ./checkThreads.sh <dir with DRsim, mergeDRsim and compareDRsim> [seed] [generators]
+#
+# generators defaults to "gun gps"; add pythia for a DRsim built with DRSIM_WITH_PYTHIA8.
+#
+# Run it where DRsim finds its inputs (the DRsim build or install directory).
+
+set -e
+
+BIN=$1
+SEED=${2:-1}
+GENERATORS=${3:-"gun gps"}
+export DRSIM_TEST_DIR=$(cd "$(dirname "$0")" && pwd)
+
+for DRSIM_GEN in $GENERATORS; do
+  export DRSIM_GEN
+  if [ $DRSIM_GEN = gps ]; then export DRSIM_GPS=True; else export DRSIM_GPS=False; fi
+  if [ $DRSIM_GEN = pythia ]; then export DRSIM_PYTHIA=True; else export DRSIM_PYTHIA=False; fi
+
+  DRSIM_THREADS=1 DRSIM_PERTHREAD=False $BIN/DRsim $DRSIM_TEST_DIR/checkThreads.mac $SEED checkThreads1_$DRSIM_GEN
+  DRSIM_THREADS=8 DRSIM_PERTHREAD=True $BIN/DRsim $DRSIM_TEST_DIR/checkThreads.mac $SEED checkThreads8_$DRSIM_GEN
+
+  $BIN/mergeDRsim checkThreads8_${DRSIM_GEN}_$SEED.root checkThreads8_${DRSIM_GEN}_${SEED}_t*.root
+  $BIN/compareDRsim checkThreads1_${DRSIM_GEN}_$SEED.root checkThreads8_${DRSIM_GEN}_$SEED.root
+done
+
+echo "checkThreads: 1 and 8 threads agree"
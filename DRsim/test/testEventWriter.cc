@@ -0,0 +1,157 @@
+// DRsimEventWriter with aborted events: 8 worker threads hand over events in the order
+// G4MTRunManager gives them out, one event (and one part of a split event) is aborted
+// and skipped. The writer must not stall behind the gap, must write every other event
+// in event_number order and must end at the right next index. A deadlock shows up as
+// the ctest timeout. Needs ROOT for the output file, no Geant4 run.
+
+#include "DRsimEventWriter.hh"
+#include "DRsimRootInterface.h"
+#include "DRsimInterface.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+  const G4int kNThread = 8;
+  const G4int kNEvent = 400;
+  const G4int kBuffer = 16;     // well below kNEvent, a stalled writer blocks the workers
+  const G4int kAborted = 37;
+  const G4int kNSubEvt = 2;
+  const G4int kAbortedSplit = 11;
+
+  DRsimInterface::DRsimEventData* makeEvent(G4int idx) {
+    DRsimInterface::DRsimEventData* evt = new DRsimInterface::DRsimEventData();
+    evt->event_number = idx;
+
+    DRsimInterface::DRsimEdepData edep;
+    edep.Edep = 1.;
+    edep.EdepEle = 0.;
+    edep.EdepGamma = 0.;
+    edep.EdepCharged = 0.;
+    edep.ModuleNum = 0;
+    evt->Edeps.push_back(edep);
+
+    return evt;
+  }
+
+  // G4 event g4evt goes to worker (g4evt/2)%kNThread, batches of two as with /run/eventModulo 2
+  G4int worker(G4int g4evt) { return (g4evt/2)%kNThread; }
+
+  // worker 0 stops at G4 event stopAt, as after AbortRun on that worker only
+  void runWorkers(DRsimEventWriter& writer, G4int nEvent, G4int nSubEvt, G4int aborted, G4int stopAt) {
+    std::vector<std::thread> workers;
+
+    for (G4int t = 0; t < kNThread; t++) {
+      workers.emplace_back([&writer,nEvent,nSubEvt,aborted,stopAt,t] {
+        std::mt19937 rng(t);
+        DRsimInterface::DRsimEventData* recycled = 0;
+
+        for (G4int first = 2*t; first < nEvent*nSubEvt; first += 2*kNThread) {
+          for (G4int g4evt = first; g4evt < std::min(first+2,nEvent*nSubEvt); g4evt++) {
+            G4int idx = g4evt/nSubEvt;
+            G4int subEvt = g4evt%nSubEvt;
+            if (t==0 && g4evt >= stopAt) {
+              delete recycled;
+              return;
+            }
+
+            std::this_thread::sleep_for(std::chrono::microseconds(rng()%200));
+
+            if (idx==aborted && subEvt==nSubEvt-1) {
+              writer.skip(idx,subEvt,nSubEvt);
+              continue;
+            }
+
+            delete recycled;
+            recycled = writer.push(makeEvent(idx),subEvt,nSubEvt);
+          }
+        }
+        delete recycled;
+      });
+    }
+
+    for (auto& worker : workers) worker.join();
+  }
+
+  // event numbers in the file, -1 marks an event out of order
+  std::vector<G4int> readBack(const std::string& filename, G4int nSubEvt, G4int& nBadEdep) {
+    DRsimRootInterface input(filename,true);
+    input.set("DRsim","DRsimEventData");
+
+    std::vector<G4int> numbers;
+    nBadEdep = 0;
+    while (input.numEvt() < input.entries()) {
+      DRsimInterface::DRsimEventData evt;
+      input.read(evt);
+
+      if (!numbers.empty() && evt.event_number <= numbers.back()) numbers.push_back(-1);
+      numbers.push_back(evt.event_number);
+
+      // sub-events are merged, 1 MeV per part
+      if (evt.Edeps.size()!=1 || evt.Edeps.front().Edep != (float)nSubEvt) nBadEdep++;
+    }
+    input.close();
+
+    return numbers;
+  }
+
+  G4int check(const char* name, G4int nextIdx, G4int expectedNext, const std::vector<G4int>& numbers, const std::vector<G4int>& expected, G4int nBadEdep) {
+    G4int nFail = 0;
+    if (nextIdx != expectedNext) { printf("%s : next index %d, expected %d\n",name,nextIdx,expectedNext); nFail++; }
+    if (numbers != expected) { printf("%s : %zu events written, expected %zu, in order\n",name,numbers.size(),expected.size()); nFail++; }
+    if (nBadEdep > 0) { printf("%s : %d events with a wrong Edep\n",name,nBadEdep); nFail++; }
+    if (nFail==0) printf("%s : ok\n",name);
+
+    return nFail;
+  }
+
+  G4int runCase(const char* name, G4int nSubEvt, G4int aborted, G4int stopAt, G4int buffer) {
+    std::string filename = std::string("testEventWriter_")+name+".root";
+
+    DRsimRootInterface* output = new DRsimRootInterface(filename,true);
+    output->create("DRsim","DRsimEventData");
+
+    DRsimEventWriter writer(output,0,buffer);
+    runWorkers(writer,kNEvent,nSubEvt,aborted,stopAt);
+    writer.finish();
+
+    output->write();
+    output->close();
+    delete output;
+
+    // every event but the aborted one and those the stopped worker never got to;
+    // the writer ends after the last event it was handed, written or not
+    std::vector<G4int> expected;
+    for (G4int idx = 0; idx < kNEvent; idx++) {
+      G4bool lost = false;
+      for (G4int sub = 0; sub < nSubEvt; sub++) {
+        G4int g4evt = idx*nSubEvt+sub;
+        if (worker(g4evt)==0 && g4evt >= stopAt) lost = true;
+      }
+      if (idx!=aborted && !lost) expected.push_back(idx);
+    }
+    G4int expectedNext = kNEvent;
+
+    G4int nBadEdep = 0;
+    std::vector<G4int> numbers = readBack(filename,nSubEvt,nBadEdep);
+
+    return check(name,writer.GetNextIdx(),expectedNext,numbers,expected,nBadEdep);
+  }
+}
+
+int main() {
+  G4int nFail = 0;
+
+  nFail += runCase("aborted",1,kAborted,kNEvent*kNSubEvt,kBuffer);
+  nFail += runCase("abortedLast",1,kNEvent-1,kNEvent*kNSubEvt,kBuffer);
+  nFail += runCase("abortedSubEvent",kNSubEvt,kAbortedSplit,kNEvent*kNSubEvt,kBuffer);
+  // the other workers run to the end; the writer holds their events behind the gap
+  // (hence the large buffer) and writes them at finish
+  nFail += runCase("stoppedWorker",1,kAborted,100,kNEvent);
+
+  return nFail > 0 ? 1 : 0;
+}
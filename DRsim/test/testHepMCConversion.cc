@@ -0,0 +1,95 @@
+// HepMCG4Interface::HepMC2Vertices on a small hand-made event: the selection of the original
+// HepMC2G4 (status 1 outgoing particles of vertices with a final-state particle, in vertex
+// order, nothing from the root vertex) and the merge of co-located vertices, which moves the
+// particles of a later vertex at the same position and time up to the first one.
+// No world solid, so no geometry and no Geant4 run.
+
+#include "HepMCG4Interface.hh"
+
+#include "G4SystemOfUnits.hh"
+
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+namespace {
+  HepMC3::GenParticlePtr particle(G4int pdgId, G4int status) {
+    return std::make_shared<HepMC3::GenParticle>(HepMC3::FourVector(0.,0.,1.,1.),pdgId,status);
+  }
+
+  HepMC3::GenVertexPtr vertex(G4double x) {
+    return std::make_shared<HepMC3::GenVertex>(HepMC3::FourVector(x,0.,0.,0.));
+  }
+
+  G4int check(const char* name, const std::vector<G4double>& x, const std::vector<std::vector<G4int>>& pdgIds, const std::vector<HepMCG4Vertex>& vertices) {
+    G4bool ok = vertices.size()==x.size();
+
+    for (size_t i = 0; ok && i < vertices.size(); i++) {
+      if (vertices[i].x != x[i]*mm || vertices[i].particles.size() != pdgIds[i].size()) ok = false;
+
+      for (size_t j = 0; ok && j < pdgIds[i].size(); j++)
+        if (vertices[i].particles[j].pdgId != pdgIds[i][j]) ok = false;
+    }
+
+    if (!ok) {
+      printf("%s : got",name);
+      for (const auto& vtx : vertices) {
+        printf(" [x %g :",vtx.x/mm);
+        for (const auto& ptc : vtx.particles) printf(" %d",ptc.pdgId);
+        printf("]");
+      }
+      printf("\n");
+      return 1;
+    }
+
+    printf("%s : ok\n",name);
+    return 0;
+  }
+}
+
+int main() {
+  HepMC3::GenEvent evt(HepMC3::Units::GEV,HepMC3::Units::MM);
+
+  // final-state photon without a production vertex, hangs on the root vertex
+  evt.add_particle(particle(22,1));
+
+  // e+e- -> Z at the origin, with an electron in the final state
+  HepMC3::GenVertexPtr vA = vertex(0.);
+  HepMC3::GenParticlePtr z = particle(23,2);
+  vA->add_particle_in(particle(11,4));
+  vA->add_particle_in(particle(-11,4));
+  vA->add_particle_out(particle(11,1));
+  vA->add_particle_out(z);
+  evt.add_vertex(vA);
+
+  // Z -> mu+ mu- and an intermediate state
+  HepMC3::GenVertexPtr vB = vertex(1.);
+  HepMC3::GenParticlePtr rho = particle(113,2);
+  vB->add_particle_in(z);
+  vB->add_particle_out(particle(13,1));
+  vB->add_particle_out(particle(-13,1));
+  vB->add_particle_out(rho);
+  evt.add_vertex(vB);
+
+  // the only final-state particle of vC has an end vertex, so vC is no real vertex
+  HepMC3::GenVertexPtr vC = vertex(2.);
+  HepMC3::GenParticlePtr pi0 = particle(111,1);
+  vC->add_particle_in(rho);
+  vC->add_particle_out(pi0);
+  evt.add_vertex(vC);
+
+  // co-located with vA, its photons join the electron
+  HepMC3::GenVertexPtr vD = vertex(0.);
+  vD->add_particle_in(pi0);
+  vD->add_particle_out(particle(22,1));
+  vD->add_particle_out(particle(22,1));
+  evt.add_vertex(vD);
+
+  std::vector<HepMCG4Vertex> vertices;
+  HepMCG4Interface::HepMC2Vertices(&evt,0,vertices);
+
+  // the original HepMC2G4 gives [x 0 : 11] [x 1 : 13 -13] [x 0 : 22 22]
+  G4int nFail = check("HepMC2Vertices",{0.,1.},{{11,22,22},{13,-13}},vertices);
+
+  return nFail > 0 ? 1 : 0;
+}
@@ -0,0 +1,118 @@
+// Equivalence of DRsimSiPMBinning + DRsimBinnedHist::GetRange with the linear scans
+// DRsimSiPMSD used before (findWavRange / findTimeRange, kept below as the reference).
+// Covers every bin edge and its neighbouring doubles, the bin centres, dense sweeps
+// beyond both ends of the axes and the non-finite values; the 99999 sentinels come
+// out of the under/overflow ranges. Needs the edge tables only, no Geant4 run.
+
+#include "DRsimSiPMBinning.hh"
+#include "DRsimBinnedHist.hh"
+
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <cstdio>
+
+namespace {
+  // the settings of DRsimSiPMSD
+  const G4int fWavBin = 60;
+  const G4int fTimeBin = 600;
+  const G4float fWavlenStart = 900.;
+  const G4float fWavlenEnd = 300.;
+  const G4float fTimeStart = 10.;
+  const G4float fTimeEnd = 70.;
+  const G4float fWavlenStep = (fWavlenStart-fWavlenEnd)/(float)fWavBin;
+  const G4float fTimeStep = (fTimeEnd-fTimeStart)/(float)fTimeBin;
+
+  G4double wavToE(G4double wav) { return h_Planck*c_light/wav; }
+
+  DRsimInterface::hitRange findWavRange(G4double en) {
+    int i = 0;
+    for ( ; i < fWavBin+1; i++) {
+      if ( en < wavToE( (fWavlenStart - (float)i*fWavlenStep)*nm ) ) break;
+    }
+
+    if (i==0) return std::make_pair(fWavlenStart,99999.);
+    else if (i==fWavBin+1) return std::make_pair(0.,fWavlenEnd);
+
+    return std::make_pair( fWavlenStart-(float)i*fWavlenStep, fWavlenStart-(float)(i-1)*fWavlenStep );
+  }
+
+  DRsimInterface::hitRange findTimeRange(G4double stepTime) {
+    int i = 0;
+    for ( ; i < fTimeBin+1; i++) {
+      if ( stepTime < ( (fTimeStart + (float)i*fTimeStep)*ns ) ) break;
+    }
+
+    if (i==0) return std::make_pair(0.,fTimeStart);
+    else if (i==fTimeBin+1) return std::make_pair(fTimeEnd,99999.);
+
+    return std::make_pair( fTimeStart+(float)(i-1)*fTimeStep, fTimeStart+(float)i*fTimeStep );
+  }
+
+  // each value plus its 8 nearest doubles on either side
+  void addNeighbours(std::vector<G4double>& values, G4double x) {
+    G4double up = x, down = x;
+    values.push_back(x);
+    for (int k = 0; k < 8; k++) {
+      up = std::nextafter(up,std::numeric_limits<G4double>::infinity());
+      down = std::nextafter(down,-std::numeric_limits<G4double>::infinity());
+      values.push_back(up);
+      values.push_back(down);
+    }
+  }
+
+  void addSpecials(std::vector<G4double>& values) {
+    const G4double inf = std::numeric_limits<G4double>::infinity();
+    for (G4double x : { 0., -0., -1., 99999., -99999., inf, -inf, std::numeric_limits<G4double>::quiet_NaN(),
+                        std::numeric_limits<G4double>::max(), std::numeric_limits<G4double>::lowest(),
+                        std::numeric_limits<G4double>::min(), std::numeric_limits<G4double>::denorm_min() }) values.push_back(x);
+  }
+}
+
+int main() {
+  DRsimSiPMBinning binning(fWavBin,fWavlenStart,fWavlenStep,fTimeBin,fTimeStart,fTimeStep);
+  DRsimBinnedHist wavlenHist(fWavBin,fWavlenStart,-fWavlenStep);
+  DRsimBinnedHist timeHist(fTimeBin,fTimeStart,fTimeStep);
+
+  std::vector<G4double> times, energies;
+
+  for (int i = 0; i < fTimeBin+1; i++) {
+    addNeighbours(times,(fTimeStart + (float)i*fTimeStep)*ns);
+    times.push_back((fTimeStart + ((float)i-0.5)*fTimeStep)*ns);
+  }
+  for (int i = 0; i < 1000000; i++) times.push_back( (-10. + 100.*i/1000000.)*ns );
+  addSpecials(times);
+
+  for (int i = 0; i < fWavBin+1; i++) {
+    addNeighbours(energies,wavToE( (fWavlenStart - (float)i*fWavlenStep)*nm ));
+    energies.push_back(wavToE( (fWavlenStart - ((float)i-0.5)*fWavlenStep)*nm ));
+  }
+  for (int i = 0; i < 1000000; i++) energies.push_back( wavToE( (1200. - 1000.*i/1000000.)*nm ) );
+  addSpecials(energies);
+
+  long nFail = 0;
+
+  for (G4double t : times) {
+    DRsimInterface::hitRange ref = findTimeRange(t);
+    DRsimInterface::hitRange out = timeHist.GetRange(binning.findTimeBin(t));
+    if (ref != out) {
+      if (nFail++ < 10) printf("time %.17g ns : (%g,%g) expected (%g,%g)\n", t/ns, out.first, out.second, ref.first, ref.second);
+    }
+  }
+
+  for (G4double en : energies) {
+    DRsimInterface::hitRange ref = findWavRange(en);
+    DRsimInterface::hitRange out = wavlenHist.GetRange(binning.findWavBin(en));
+    if (ref != out) {
+      if (nFail++ < 10) printf("energy %.17g eV : (%g,%g) expected (%g,%g)\n", en/eV, out.first, out.second, ref.first, ref.second);
+    }
+  }
+
+  // the sentinel ranges themselves
+  if ( timeHist.GetRange(binning.findTimeBin(1.e6*ns)) != std::make_pair(fTimeEnd,99999.f) ) nFail++;
+  if ( wavlenHist.GetRange(binning.findWavBin(0.)) != std::make_pair(fWavlenStart,99999.f) ) nFail++;
+
+  printf("testSiPMBinning: %zu times, %zu energies, %ld mismatch(es)\n", times.size(), energies.size(), nFail);
+
+  return nFail == 0 ? 0 : 1;
+}
@@ -1,5 +1,6 @@
 #include "DRsimInterface.h"
 #include "RootInterface.h"
+#include "DRsimRootInterface.h"
 #include "fastjetInterface.h"
 #include "RecoTower.h"
 
@@ -19,8 +20,9 @@ int main(int argc, char* argv[]) {
   fastjetInterface fjFiber_C;
   fjFiber_C.init(recoInterface->getTree(),"RecoFiberJets_C");
 
-  RootInterface<DRsimInterface::DRsimEventData>* drInterface = new RootInterface<DRsimInterface::DRsimEventData>(filename+"_"+filenum+".root");
+  DRsimRootInterface* drInterface = new DRsimRootInterface(filename+"_"+filenum+".root");
   drInterface->set("DRsim","DRsimEventData");
+  if (drInterface->photonPrescale() > 1) std::cout << "SiPM counts are weighted by the photon prescale " << drInterface->photonPrescale() << std::endl;
 
   RecoTower* recoTower = new RecoTower();
   recoTower->readCSV();
@@ -32,6 +34,7 @@ int main(int argc, char* argv[]) {
     DRsimInterface::DRsimEventData evt;
     RecoInterface::RecoEventData* recoEvt = new RecoInterface::RecoEventData();
     drInterface->read(evt);
+    recoEvt->photonPrescale = drInterface->photonPrescale();
 
     for (auto towerItr = evt.towers.begin(); towerItr != evt.towers.end(); ++towerItr) {
       auto tower = *towerItr;
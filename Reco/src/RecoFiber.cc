@@ -38,6 +38,8 @@ void RecoFiber::reconstruct(const DRsimInterface::DRsimSiPMData& sipm, RecoInter
   recoTower.fibers.push_back(fData);
 }
 
+// counts are pre-scale weighted integers, so the peak search and the sum below need no rescaling;
+// a pre-scaled sample only makes the peak position noisier
 float RecoFiber::setTmax(const DRsimInterface::DRsimSiPMData& sipm) {
   std::pair<DRsimInterface::hitRange,int> maxima = std::make_pair(std::make_pair(0.,0.),0);
   for (auto timeItr = sipm.timeStruct.begin(); timeItr != sipm.timeStruct.end(); ++timeItr) {
@@ -1,4 +1,5 @@
 #include "RootInterface.h"
+#include "DRsimRootInterface.h"
 #include "RecoInterface.h"
 #include "DRsimInterface.h"
 #include "fastjetInterface.h"
@@ -60,7 +61,7 @@ int main(int argc, char* argv[]) {
   RootInterface<RecoInterface::RecoEventData>* recoInterface = new RootInterface<RecoInterface::RecoEventData>(std::string(filename)+".root");
   recoInterface->set("Reco","RecoEventData");
 
-  RootInterface<DRsimInterface::DRsimEventData>* drInterface = new RootInterface<DRsimInterface::DRsimEventData>(std::string(filename)+".root");
+  DRsimRootInterface* drInterface = new DRsimRootInterface(std::string(filename)+".root");
   drInterface->set("DRsim","DRsimEventData");
 
   HepMC3::ReaderRootTree reader(std::string(filename)+".root");
@@ -1,4 +1,4 @@
-#include "RootInterface.h"
+#include "DRsimRootInterface.h"
 #include "RecoInterface.h"
 #include "DRsimInterface.h"
 #include "functions.h"
@@ -26,7 +26,7 @@ int main(int argc, char* argv[]) {
 
   gStyle->SetOptFit(1);
 
-  RootInterface<DRsimInterface::DRsimEventData>* drInterface = new RootInterface<DRsimInterface::DRsimEventData>(std::string(filename), false);
+  DRsimRootInterface* drInterface = new DRsimRootInterface(std::string(filename), false);
   drInterface->GetChain("DRsim");
 
   TH1F* tEdep = new TH1F("totEdep","Total Energy deposit;MeV;Evt",100,low*1000.,high*1000.);
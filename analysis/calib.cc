@@ -1,4 +1,4 @@
-#include "RootInterface.h"
+#include "DRsimRootInterface.h"
 #include "RecoInterface.h"
 #include "DRsimInterface.h"
 #include "functions.h"
@@ -52,7 +52,7 @@ int main(int argc, char* argv[]) {
   TH1I* Shit = new TH1I("S_Hit","hits of Scintillation ch",100,0.,40000.);
   Shit->Sumw2(); Shit->SetLineColor(kRed); Shit->SetLineWidth(2);
 
-  RootInterface<DRsimInterface::DRsimEventData>* drInterface = new RootInterface<DRsimInterface::DRsimEventData>(std::string(filename)+".root");
+  DRsimRootInterface* drInterface = new DRsimRootInterface(std::string(filename)+".root");
   drInterface->set("DRsim","DRsimEventData");
 
   unsigned int entries = drInterface->entries();
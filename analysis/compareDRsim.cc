@@ -0,0 +1,107 @@
+#include "DRsimRootInterface.h"
+#include "DRsimInterface.h"
+
+#include <iostream>
+#include <string>
+
+namespace {
+  // first difference of two events with the same event_number, empty if they agree
+  std::string compare(const DRsimInterface::DRsimEventData& a, const DRsimInterface::DRsimEventData& b) {
+    if (a.towers.size() != b.towers.size()) return "number of towers";
+    for (unsigned int i = 0; i < a.towers.size(); i++) {
+      const auto& ta = a.towers.at(i);
+      const auto& tb = b.towers.at(i);
+      if (ta.ModuleNum != tb.ModuleNum || ta.SiPMs.size() != tb.SiPMs.size()) return "tower "+std::to_string(i);
+
+      for (unsigned int j = 0; j < ta.SiPMs.size(); j++) {
+        const auto& sa = ta.SiPMs.at(j);
+        const auto& sb = tb.SiPMs.at(j);
+        if (sa.SiPMnum != sb.SiPMnum || sa.count != sb.count || sa.timeStruct != sb.timeStruct || sa.wavlenSpectrum != sb.wavlenSpectrum)
+          return "SiPM "+std::to_string(sa.SiPMnum)+" of module "+std::to_string(ta.ModuleNum);
+      }
+    }
+
+    if (a.Edeps.size() != b.Edeps.size()) return "number of Edeps";
+    for (unsigned int i = 0; i < a.Edeps.size(); i++) {
+      const auto& ea = a.Edeps.at(i);
+      const auto& eb = b.Edeps.at(i);
+      if (ea.ModuleNum != eb.ModuleNum || ea.Edep != eb.Edep || ea.EdepEle != eb.EdepEle || ea.EdepGamma != eb.EdepGamma || ea.EdepCharged != eb.EdepCharged)
+        return "Edep of module "+std::to_string(ea.ModuleNum);
+    }
+
+    if (a.leaks.size() != b.leaks.size()) return "number of leaks";
+    for (unsigned int i = 0; i < a.leaks.size(); i++) {
+      if (a.leaks.at(i).pdgId != b.leaks.at(i).pdgId || a.leaks.at(i).E != b.leaks.at(i).E) return "leak "+std::to_string(i);
+    }
+
+    if (a.GenPtcs.size() != b.GenPtcs.size()) return "number of GenPtcs";
+    for (unsigned int i = 0; i < a.GenPtcs.size(); i++) {
+      if (a.GenPtcs.at(i).pdgId != b.GenPtcs.at(i).pdgId || a.GenPtcs.at(i).E != b.GenPtcs.at(i).E) return "GenPtc "+std::to_string(i);
+    }
+
+    return "";
+  }
+
+  // true if the event saw anything, two empty files would agree trivially
+  bool hasSignal(const DRsimInterface::DRsimEventData& evt) {
+    for (const auto& tower : evt.towers) {
+      for (const auto& sipm : tower.SiPMs)
+        if (sipm.count > 0) return true;
+    }
+    for (const auto& edep : evt.Edeps)
+      if (edep.Edep > 0.) return true;
+
+    return false;
+  }
+}
+
+// compares two DRsim files ordered by event_number (shared writer or mergeDRsim output),
+// e.g. the same job run with different /run/numberOfThreads. Returns 1 on any difference
+// and when a file has no hit and no Edep in any event.
+int main(int argc, char* argv[]) {
+  if (argc != 3) {
+    std::cerr << "Usage: " << argv[0] << " <a.root> <b.root>" << std::endl;
+    return 1;
+  }
+
+  DRsimRootInterface* inputs[2];
+  for (int i = 0; i < 2; i++) {
+    inputs[i] = new DRsimRootInterface(std::string(argv[i+1]), true);
+    inputs[i]->set("DRsim","DRsimEventData");
+  }
+
+  unsigned int entries[2] = {inputs[0]->entries(), inputs[1]->entries()};
+  if (entries[0] != entries[1]) std::cout << "different number of events : " << entries[0] << " vs " << entries[1] << std::endl;
+
+  unsigned int numCompared = 0, numDiff = 0, numSignal[2] = {0, 0};
+  while (inputs[0]->numEvt() < entries[0] && inputs[1]->numEvt() < entries[1]) {
+    DRsimInterface::DRsimEventData evt[2];
+    inputs[0]->read(evt[0]);
+    inputs[1]->read(evt[1]);
+
+    if (evt[0].event_number != evt[1].event_number) {
+      std::cout << "event_number " << evt[0].event_number << " vs " << evt[1].event_number << ", files are not ordered alike" << std::endl;
+      numDiff++;
+      break;
+    }
+
+    for (int i = 0; i < 2; i++)
+      if (hasSignal(evt[i])) numSignal[i]++;
+
+    std::string diff = compare(evt[0],evt[1]);
+    if (!diff.empty()) {
+      std::cout << "event " << evt[0].event_number << " differs : " << diff << std::endl;
+      numDiff++;
+    }
+    numCompared++;
+  } // event loop
+
+  for (auto input : inputs) input->close();
+
+  std::cout << numCompared << " events compared, " << numDiff << " differ" << std::endl;
+
+  bool empty = numSignal[0]==0 || numSignal[1]==0;
+  if (empty) std::cout << "no hit and no Edep in " << ( numSignal[0]==0 ? argv[1] : argv[2] ) << ", nothing was compared" << std::endl;
+
+  return ( numDiff > 0 || entries[0] != entries[1] || empty ) ? 1 : 0;
+}
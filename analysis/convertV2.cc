@@ -0,0 +1,51 @@
+#include "DRsimRootInterface.h"
+#include "DRsimInterface.h"
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace {
+  long fileSize(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    return file ? (long)file.tellg() : -1;
+  }
+}
+
+// rewrites a DRsim output file in the columnar (v2) layout and prints both file sizes
+int main(int argc, char* argv[]) {
+  if (argc != 3) {
+    std::cerr << "Usage: " << argv[0] << " <input.root> <output.root>" << std::endl;
+    return 1;
+  }
+
+  std::string input = argv[1];
+  std::string output = argv[2];
+
+  DRsimRootInterface* drInterface = new DRsimRootInterface(input, true);
+  drInterface->set("DRsim","DRsimEventData");
+
+  DRsimRootInterface* v2Interface = new DRsimRootInterface(output, true);
+  v2Interface->createV2("DRsim","DRsimEventData");
+  v2Interface->setPhotonPrescale(drInterface->photonPrescale());
+
+  unsigned int entries = drInterface->entries();
+  while (drInterface->numEvt() < entries) {
+    if (drInterface->numEvt() % 100 == 0) printf("Converting %dth event ...\n", drInterface->numEvt());
+
+    DRsimInterface::DRsimEventData evt;
+    drInterface->read(evt);
+    v2Interface->fill(&evt);
+  } // event loop
+
+  drInterface->close();
+  v2Interface->write();
+  v2Interface->close();
+
+  long sizes[2] = {fileSize(input), fileSize(output)};
+  std::cout << entries << " events, " << input << " : " << sizes[0] << " bytes, " << output << " : " << sizes[1] << " bytes";
+  if (sizes[0] > 0 && sizes[1] > 0) std::cout << ", v2/input = " << (double)sizes[1]/sizes[0];
+  std::cout << std::endl;
+
+  return 0;
+}
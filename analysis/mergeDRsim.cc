@@ -0,0 +1,69 @@
+#include "DRsimRootInterface.h"
+#include "DRsimInterface.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+// merges per-thread DRsim files into one file ordered by event_number.
+// Each input is already ordered (a worker only ever gets increasing event indices),
+// so a k-way merge holding one event per input is enough.
+int main(int argc, char* argv[]) {
+  if (argc < 3) {
+    std::cerr << "Usage: " << argv[0] << " <output.root> <input_t0.root> [<input_t1.root> ...]" << std::endl;
+    return 1;
+  }
+
+  std::string output = argv[1];
+  std::vector<DRsimRootInterface*> inputs;
+  for (int i = 2; i < argc; i++) {
+    DRsimRootInterface* drInterface = new DRsimRootInterface(std::string(argv[i]), true);
+    drInterface->set("DRsim","DRsimEventData");
+    inputs.push_back(drInterface);
+  }
+
+  DRsimRootInterface* outInterface = new DRsimRootInterface(output, true);
+  if (inputs.front()->isV2()) outInterface->createV2("DRsim","DRsimEventData");
+  else outInterface->create("DRsim","DRsimEventData");
+
+  // the counts of files with different prescales are weighted differently, refuse to mix them
+  for (auto input : inputs) {
+    if (input->photonPrescale() != inputs.front()->photonPrescale()) {
+      std::cerr << "inputs were written with photon prescales " << inputs.front()->photonPrescale() << " and " << input->photonPrescale() << std::endl;
+      return 1;
+    }
+  }
+  outInterface->setPhotonPrescale(inputs.front()->photonPrescale());
+
+  std::vector<DRsimInterface::DRsimEventData> heads(inputs.size());
+  std::vector<bool> valid(inputs.size(),false);
+  for (unsigned int i = 0; i < inputs.size(); i++) {
+    if (inputs.at(i)->numEvt() < inputs.at(i)->entries()) {
+      inputs.at(i)->read(heads.at(i));
+      valid.at(i) = true;
+    }
+  }
+
+  unsigned int numWritten = 0;
+  while (true) {
+    int next = -1;
+    for (unsigned int i = 0; i < inputs.size(); i++) {
+      if (!valid.at(i)) continue;
+      if (next < 0 || heads.at(i).event_number < heads.at(next).event_number) next = i;
+    }
+    if (next < 0) break;
+
+    if (numWritten % 100 == 0) printf("Merging %dth event ...\n", numWritten);
+    outInterface->fill(&heads.at(next));
+    numWritten++;
+
+    if (inputs.at(next)->numEvt() < inputs.at(next)->entries()) inputs.at(next)->read(heads.at(next));
+    else valid.at(next) = false;
+  } // event loop
+
+  for (auto input : inputs) input->close();
+  outInterface->write();
+  outInterface->close();
+
+  return 0;
+}
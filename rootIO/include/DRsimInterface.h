@@ -27,9 +27,13 @@ public:
 
   struct DRsimSiPMData {
     DRsimSiPMData() {};
+    DRsimSiPMData(const DRsimSiPMData&) = default;
+    DRsimSiPMData(DRsimSiPMData&&) = default;
+    DRsimSiPMData& operator=(const DRsimSiPMData&) = default;
+    DRsimSiPMData& operator=(DRsimSiPMData&&) = default;
     virtual ~DRsimSiPMData() {};
 
-    int count;
+    int count; // photons times the DRsim photon pre-scale, as are the histogram entries
     int SiPMnum;
     int x;    // plate num
     int y;    // fiber num on the plate
@@ -40,6 +44,10 @@ public:
 
   struct DRsimTowerData {
     DRsimTowerData() {};
+    DRsimTowerData(const DRsimTowerData&) = default;
+    DRsimTowerData(DRsimTowerData&&) = default;
+    DRsimTowerData& operator=(const DRsimTowerData&) = default;
+    DRsimTowerData& operator=(DRsimTowerData&&) = default;
     virtual ~DRsimTowerData() {};
 
     int ModuleNum;
@@ -91,6 +99,10 @@ public:
 
   struct DRsimEventData {
     DRsimEventData() {};
+    DRsimEventData(const DRsimEventData&) = default;
+    DRsimEventData(DRsimEventData&&) = default;
+    DRsimEventData& operator=(const DRsimEventData&) = default;
+    DRsimEventData& operator=(DRsimEventData&&) = default;
     virtual ~DRsimEventData() {};
 
     int event_number;
@@ -100,6 +112,60 @@ public:
     std::vector<DRsimGenData> GenPtcs;
   };
 
+  // run header, written once per file: the bin ranges of the columnar (v2) layout,
+  // which events refer to by index, and the photon prescale the counts are weighted with
+  struct DRsimBinningHeader {
+    DRsimBinningHeader() : photonPrescale(1) {};
+    virtual ~DRsimBinningHeader() {};
+
+    int timeIndex(const hitRange& range);   // appends ranges not seen before
+    int wavlenIndex(const hitRange& range);
+
+    std::vector<hitRange> timeBins;
+    std::vector<hitRange> wavlenBins;
+    int photonPrescale;
+
+    std::map<hitRange, int> fTimeLookup; //!
+    std::map<hitRange, int> fWavlenLookup; //!
+  };
+
+  // columnar (v2) event layout: struct-of-arrays over all SiPMs of the event,
+  // with the time and wavelength histograms stored as sparse (bin, count) pairs.
+  // Towers own tower_nSiPM consecutive SiPMs, SiPMs own SiPM_nTime/SiPM_nWavlen
+  // consecutive histogram entries.
+  struct DRsimEventDataV2 {
+    DRsimEventDataV2() {};
+    virtual ~DRsimEventDataV2() {};
+
+    int event_number;
+
+    std::vector<int> tower_ModuleNum;
+    std::vector<int> tower_numx;
+    std::vector<int> tower_numy;
+    std::vector<int> tower_nSiPM;
+
+    std::vector<int> SiPM_count;
+    std::vector<int> SiPM_num;
+    std::vector<int> SiPM_x;
+    std::vector<int> SiPM_y;
+    std::vector<float> SiPM_posx;
+    std::vector<float> SiPM_posy;
+    std::vector<float> SiPM_posz;
+    std::vector<int> SiPM_nTime;
+    std::vector<int> SiPM_nWavlen;
+
+    std::vector<unsigned short> time_bin;
+    std::vector<int> time_count;
+    std::vector<unsigned short> wavlen_bin;
+    std::vector<int> wavlen_count;
+
+    std::vector<DRsimEdepData> Edeps;
+    std::vector<DRsimLeakageData> leaks;
+    std::vector<DRsimGenData> GenPtcs;
+  };
+
+  static void toV2(const DRsimEventData& evt, DRsimEventDataV2& out, DRsimBinningHeader& header);
+  static void fromV2(const DRsimEventDataV2& evt, const DRsimBinningHeader& header, DRsimEventData& out);
 };
 
 #endif
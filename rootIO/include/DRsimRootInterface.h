@@ -0,0 +1,41 @@
+#ifndef DRsimRootInterface_h
+#define DRsimRootInterface_h 1
+
+#include "RootInterface.h"
+#include "DRsimInterface.h"
+
+// RootInterface for DRsim trees, which carry either the DRsimEventData branch or the
+// columnar (v2) one named <title>V2. Both layouts have a DRsimBinningHeader per file
+// (files written before the header existed read as prescale 1).
+// read() returns DRsimEventData for both layouts.
+class DRsimRootInterface : public RootInterface<DRsimInterface::DRsimEventData> {
+public:
+  DRsimRootInterface(const std::string& filename, bool key);
+  ~DRsimRootInterface();
+
+  void fill(const DRsimInterface::DRsimEventData* evt);
+  void fill(DRsimInterface::DRsimEventData&& evt);
+  void GetChain(const std::string& treename);
+  void read(DRsimInterface::DRsimEventData& evt);
+  void create(const std::string& name, const std::string& title);
+  void createV2(const std::string& name, const std::string& title);
+  void set(const std::string& name, const std::string& title);
+  void write();
+  void close();
+
+  bool isV2() const { return fEventDataV2!=0; }
+
+  // of the file the last event was read from (or of the file set() opened)
+  int photonPrescale() const { return fHeader ? fHeader->photonPrescale : 1; }
+  void setPhotonPrescale(int prescale) { fHeader->photonPrescale = prescale; }
+
+private:
+  void setBranch(const std::string& title);
+  void readHeader();
+
+  DRsimInterface::DRsimEventDataV2* fEventDataV2;
+  DRsimInterface::DRsimBinningHeader* fHeader;
+  int fTreeNumber;
+};
+
+#endif
@@ -18,6 +18,9 @@
 #pragma link C++ struct DRsimInterface::DRsimLeakageData+;
 #pragma link C++ struct DRsimInterface::DRsimGenData+;
 #pragma link C++ struct DRsimInterface::DRsimEventData+;
+#pragma link C++ class std::vector<DRsimInterface::hitRange>+;
+#pragma link C++ struct DRsimInterface::DRsimBinningHeader+;
+#pragma link C++ struct DRsimInterface::DRsimEventDataV2+;
 
 #pragma link C++ struct RecoInterface::RecoFiberData+;
 #pragma link C++ struct RecoInterface::RecoTowerData+;
@@ -54,6 +54,7 @@ public:
     float E_DRcorr;
     int n_C;
     int n_S;
+    int photonPrescale; // SiPM counts are weighted by it, see DRsimBinningHeader
     std::vector<RecoTowerData> towers;
   };
 
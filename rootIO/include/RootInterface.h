@@ -13,6 +13,7 @@ public:
   ~RootInterface();
 
   void fill(const T* evt);
+  void fill(T&& evt); // takes over the contents of evt instead of copying them
   void GetChain(const std::string& treename);
   void read(T& evt);
   void create(const std::string& name, const std::string& title);
@@ -24,7 +25,7 @@ public:
   unsigned int entries() { return fTree->GetEntries(); }
   unsigned int numEvt() { return fNumEvt; }
 
-private:
+protected:
   void init();
   void PrepareChain();
 
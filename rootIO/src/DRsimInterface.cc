@@ -2,3 +2,118 @@
 
 DRsimInterface::DRsimInterface() {}
 DRsimInterface::~DRsimInterface() {}
+
+int DRsimInterface::DRsimBinningHeader::timeIndex(const hitRange& range) {
+  auto it = fTimeLookup.find(range);
+  if (it!=fTimeLookup.end()) return it->second;
+
+  int idx = timeBins.size();
+  timeBins.push_back(range);
+  fTimeLookup.insert(std::make_pair(range,idx));
+
+  return idx;
+}
+
+int DRsimInterface::DRsimBinningHeader::wavlenIndex(const hitRange& range) {
+  auto it = fWavlenLookup.find(range);
+  if (it!=fWavlenLookup.end()) return it->second;
+
+  int idx = wavlenBins.size();
+  wavlenBins.push_back(range);
+  fWavlenLookup.insert(std::make_pair(range,idx));
+
+  return idx;
+}
+
+void DRsimInterface::toV2(const DRsimEventData& evt, DRsimEventDataV2& out, DRsimBinningHeader& header) {
+  out.event_number = evt.event_number;
+
+  out.tower_ModuleNum.clear();
+  out.tower_numx.clear();
+  out.tower_numy.clear();
+  out.tower_nSiPM.clear();
+  out.SiPM_count.clear();
+  out.SiPM_num.clear();
+  out.SiPM_x.clear();
+  out.SiPM_y.clear();
+  out.SiPM_posx.clear();
+  out.SiPM_posy.clear();
+  out.SiPM_posz.clear();
+  out.SiPM_nTime.clear();
+  out.SiPM_nWavlen.clear();
+  out.time_bin.clear();
+  out.time_count.clear();
+  out.wavlen_bin.clear();
+  out.wavlen_count.clear();
+
+  for (const auto& tower : evt.towers) {
+    out.tower_ModuleNum.push_back(tower.ModuleNum);
+    out.tower_numx.push_back(tower.numx);
+    out.tower_numy.push_back(tower.numy);
+    out.tower_nSiPM.push_back(tower.SiPMs.size());
+
+    for (const auto& sipm : tower.SiPMs) {
+      out.SiPM_count.push_back(sipm.count);
+      out.SiPM_num.push_back(sipm.SiPMnum);
+      out.SiPM_x.push_back(sipm.x);
+      out.SiPM_y.push_back(sipm.y);
+      out.SiPM_posx.push_back(std::get<0>(sipm.pos));
+      out.SiPM_posy.push_back(std::get<1>(sipm.pos));
+      out.SiPM_posz.push_back(std::get<2>(sipm.pos));
+      out.SiPM_nTime.push_back(sipm.timeStruct.size());
+      out.SiPM_nWavlen.push_back(sipm.wavlenSpectrum.size());
+
+      for (const auto& timepair : sipm.timeStruct) {
+        out.time_bin.push_back(header.timeIndex(timepair.first));
+        out.time_count.push_back(timepair.second);
+      }
+      for (const auto& wavpair : sipm.wavlenSpectrum) {
+        out.wavlen_bin.push_back(header.wavlenIndex(wavpair.first));
+        out.wavlen_count.push_back(wavpair.second);
+      }
+    }
+  }
+
+  out.Edeps = evt.Edeps;
+  out.leaks = evt.leaks;
+  out.GenPtcs = evt.GenPtcs;
+}
+
+void DRsimInterface::fromV2(const DRsimEventDataV2& evt, const DRsimBinningHeader& header, DRsimEventData& out) {
+  out.event_number = evt.event_number;
+  out.towers.clear();
+  out.towers.resize(evt.tower_ModuleNum.size());
+
+  unsigned int iSiPM = 0;
+  unsigned int iTime = 0;
+  unsigned int iWav = 0;
+
+  for (unsigned int iTower = 0; iTower < evt.tower_ModuleNum.size(); iTower++) {
+    DRsimTowerData& tower = out.towers.at(iTower);
+    tower.ModuleNum = evt.tower_ModuleNum.at(iTower);
+    tower.numx = evt.tower_numx.at(iTower);
+    tower.numy = evt.tower_numy.at(iTower);
+    tower.SiPMs.resize(evt.tower_nSiPM.at(iTower));
+
+    for (auto& sipm : tower.SiPMs) {
+      sipm.count = evt.SiPM_count.at(iSiPM);
+      sipm.SiPMnum = evt.SiPM_num.at(iSiPM);
+      sipm.x = evt.SiPM_x.at(iSiPM);
+      sipm.y = evt.SiPM_y.at(iSiPM);
+      sipm.pos = std::make_tuple(evt.SiPM_posx.at(iSiPM),evt.SiPM_posy.at(iSiPM),evt.SiPM_posz.at(iSiPM));
+
+      // entries were written in map order, so hinted insertion at end() is constant time
+      for (int i = 0; i < evt.SiPM_nTime.at(iSiPM); i++, iTime++) {
+        sipm.timeStruct.emplace_hint(sipm.timeStruct.end(),header.timeBins.at(evt.time_bin.at(iTime)),evt.time_count.at(iTime));
+      }
+      for (int i = 0; i < evt.SiPM_nWavlen.at(iSiPM); i++, iWav++) {
+        sipm.wavlenSpectrum.emplace_hint(sipm.wavlenSpectrum.end(),header.wavlenBins.at(evt.wavlen_bin.at(iWav)),evt.wavlen_count.at(iWav));
+      }
+      iSiPM++;
+    }
+  }
+
+  out.Edeps = evt.Edeps;
+  out.leaks = evt.leaks;
+  out.GenPtcs = evt.GenPtcs;
+}
@@ -0,0 +1,96 @@
+#include "DRsimRootInterface.h"
+
+DRsimRootInterface::DRsimRootInterface(const std::string& filename, bool key)
+: RootInterface<DRsimInterface::DRsimEventData>(filename,key),
+  fEventDataV2(0), fHeader(0), fTreeNumber(-1) {}
+
+DRsimRootInterface::~DRsimRootInterface() {}
+
+void DRsimRootInterface::GetChain(const std::string& treename) {
+  fChain = new TChain(treename.c_str());
+  fChain->Add((fFilename+"/*.root").c_str());
+  fTree = fChain;
+  setBranch(treename+"EventData");
+}
+
+void DRsimRootInterface::create(const std::string& name, const std::string& title) {
+  RootInterface<DRsimInterface::DRsimEventData>::create(name,title);
+  fHeader = new DRsimInterface::DRsimBinningHeader();
+}
+
+void DRsimRootInterface::createV2(const std::string& name, const std::string& title) {
+  fEventDataV2 = new DRsimInterface::DRsimEventDataV2();
+  fHeader = new DRsimInterface::DRsimBinningHeader();
+  fTree = new TTree(name.c_str(),name.c_str());
+  fTree->Branch((title+"V2").c_str(),fEventDataV2);
+}
+
+void DRsimRootInterface::set(const std::string& name, const std::string& title) {
+  fTree = (TTree*)fFile->Get(name.c_str());
+  setBranch(title);
+  readHeader();
+}
+
+void DRsimRootInterface::setBranch(const std::string& title) {
+  if (fTree->GetBranch((title+"V2").c_str())) {
+    fEventDataV2 = new DRsimInterface::DRsimEventDataV2();
+    fTree->SetBranchAddress((title+"V2").c_str(),&fEventDataV2);
+    return;
+  }
+
+  fTree->SetBranchAddress(title.c_str(),&fEventData);
+}
+
+// the header is stored per file, so reload it whenever a chain moves on to the next file
+void DRsimRootInterface::readHeader() {
+  if (fTree->GetTreeNumber()==fTreeNumber || !fTree->GetCurrentFile()) return;
+
+  delete fHeader;
+  fHeader = 0;
+  fTree->GetCurrentFile()->GetObject("DRsimBinningHeader",fHeader);
+  fTreeNumber = fTree->GetTreeNumber();
+}
+
+void DRsimRootInterface::fill(DRsimInterface::DRsimEventData&& evt) {
+  if (!fEventDataV2) {
+    RootInterface<DRsimInterface::DRsimEventData>::fill(std::move(evt));
+    return;
+  }
+
+  DRsimInterface::toV2(evt,*fEventDataV2,*fHeader);
+  fTree->Fill();
+}
+
+void DRsimRootInterface::fill(const DRsimInterface::DRsimEventData* evt) {
+  if (!fEventDataV2) {
+    RootInterface<DRsimInterface::DRsimEventData>::fill(evt);
+    return;
+  }
+
+  DRsimInterface::toV2(*evt,*fEventDataV2,*fHeader);
+  fTree->Fill();
+}
+
+void DRsimRootInterface::read(DRsimInterface::DRsimEventData& evt) {
+  if (!fEventDataV2) {
+    RootInterface<DRsimInterface::DRsimEventData>::read(evt);
+    readHeader();
+    return;
+  }
+
+  fTree->GetEntry(fNumEvt);
+  readHeader();
+  DRsimInterface::fromV2(*fEventDataV2,*fHeader,evt);
+  fNumEvt++;
+}
+
+void DRsimRootInterface::write() {
+  RootInterface<DRsimInterface::DRsimEventData>::write();
+  if (fHeader) fFile->WriteObject(fHeader,"DRsimBinningHeader");
+}
+
+void DRsimRootInterface::close() {
+  RootInterface<DRsimInterface::DRsimEventData>::close();
+  if (fEventDataV2) delete fEventDataV2;
+  if (fHeader) delete fHeader;
+}
@@ -35,6 +35,7 @@ RecoInterface::RecoEventData::RecoEventData() {
   E_DRcorr = 0.;
   n_C = 0;
   n_S = 0;
+  photonPrescale = 1;
 }
 
 bool RecoInterface::IsCerenkov(int col, int row) {
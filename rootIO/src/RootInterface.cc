@@ -4,7 +4,7 @@
 
 template <typename T>
 RootInterface<T>::RootInterface(const std::string& filename, bool key)
-: fFilename(filename), fNumEvt(0) {
+: fChain(0), fFile(0), fTree(0), fFilename(filename), fEventData(0), fNumEvt(0) {
   if (key) init();
   if (!key) PrepareChain();
 }
@@ -49,6 +49,12 @@ void RootInterface<T>::fill(const T* evt) {
   fTree->Fill();
 }
 
+template <typename T>
+void RootInterface<T>::fill(T&& evt) {
+  std::swap(*fEventData,evt);
+  fTree->Fill();
+}
+
 template <typename T>
 void RootInterface<T>::read(T& evt) {
   fTree->GetEntry(fNumEvt);